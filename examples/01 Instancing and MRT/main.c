@@ -219,6 +219,11 @@ i32 main()
       NULL);
 
   glDebugMessageCallback(gpu_dbg_msg_cb, NULL);
+  gpu_frames_in_flight(2);
+
+  let pref_path = SDL_GetPrefPath("gpulib", "Instancing and MRT");
+  gpu_pro_cache(pref_path);
+  SDL_free(pref_path);
 
   i64 monkey_bytes = 0;
   i64 sphere_bytes = 0;
@@ -268,19 +273,13 @@ i32 main()
   };
   // clang-format on
 
-  vec3 * pos = gpu_malloc(90 * bytesof(vec3));
-
-  for (ptrdiff_t i = 0, row = 10, space = 3; i < 90; ++i)
-  {
-    pos[i].x = (f32)(i * space - (i / row) * row * space);
-    pos[i].y = 0;
-    pos[i].z = (f32)((i / row) * space);
-  }
+  struct gpu_ring_t pos_ring;
+  gpu_ring(&pos_ring, 90 * bytesof(vec3), 3);
 
   // clang-format off
-  let monkey_pos_tex = gpu_cast(pos, gpu_xyz_f32_t, 00 * bytesof(vec3), 30 * bytesof(vec3));
-  let sphere_pos_tex = gpu_cast(pos, gpu_xyz_f32_t, 30 * bytesof(vec3), 30 * bytesof(vec3));
-  let teapot_pos_tex = gpu_cast(pos, gpu_xyz_f32_t, 60 * bytesof(vec3), 30 * bytesof(vec3));
+  let monkey_pos_tex = gpu_cast(pos_ring.mem, gpu_xyz_f32_t, 00 * bytesof(vec3), 30 * bytesof(vec3));
+  let sphere_pos_tex = gpu_cast(pos_ring.mem, gpu_xyz_f32_t, 30 * bytesof(vec3), 30 * bytesof(vec3));
+  let teapot_pos_tex = gpu_cast(pos_ring.mem, gpu_xyz_f32_t, 60 * bytesof(vec3), 30 * bytesof(vec3));
 
   const c8 * tex[] =
   {
@@ -476,7 +475,20 @@ i32 main()
     if (key[SDL_SCANCODE_7]) show_pass = 7;
     // clang-format on
 
-    forcount(i, 90) { pos[i].y = (f32)sin(t_curr * 0.0015f + i * 0.5f) * 0.3f; }
+    vec3 * pos = gpu_ring_begin(&pos_ring);
+
+    for (ptrdiff_t i = 0, row = 10, space = 3; i < 90; ++i)
+    {
+      pos[i].x = (f32)(i * space - (i / row) * row * space);
+      pos[i].y = (f32)sin(t_curr * 0.0015f + i * 0.5f) * 0.3f;
+      pos[i].z = (f32)((i / row) * space);
+    }
+
+    // clang-format off
+    gpu_ring_cast(&pos_ring, monkey_pos_tex, gpu_xyz_f32_t, 00 * bytesof(vec3), 30 * bytesof(vec3));
+    gpu_ring_cast(&pos_ring, sphere_pos_tex, gpu_xyz_f32_t, 30 * bytesof(vec3), 30 * bytesof(vec3));
+    gpu_ring_cast(&pos_ring, teapot_pos_tex, gpu_xyz_f32_t, 60 * bytesof(vec3), 30 * bytesof(vec3));
+    // clang-format on
 
     gpu_f32(mesh_vert, 1, 1, &fcoef);
     gpu_vec3(mesh_vert, 2, 1, &cam_pos.x);
@@ -495,6 +507,8 @@ i32 main()
     gpu_draw(countof(ops), ops);
     gpu_bind_fbo(0);
 
+    gpu_ring_end(&pos_ring);
+
     gpu_clear();
 
     if (!show_pass)
@@ -89,19 +89,6 @@ static void gpu_dbg_msg_cb(
 }
 // clang-format on
 
-typedef struct
-{
-  f32 x, y, z, w;
-} vec4;
-
-internal void SDLFree(void ** memory)
-{
-  if (memory)
-  {
-    SDL_free(*memory);
-  }
-}
-
 i32 main()
 {
   SDL_Window * sdl_window = NULL;
@@ -158,7 +145,7 @@ i32 main()
   let frag = gpu_frag(frag_string);
   let ppo = gpu_ppo(vert, frag);
 
-  let img_tex = gpu_malloc_img(gpu_rgba_f32_t, dim_x, dim_y, 1, 1);
+  let img_tex = gpu_malloc_img(gpu_r_f32_t, dim_x, dim_y, 1, 1);
   let fbo = gpu_fbo(img_tex, 0, 0, 0, 0, 0, 0, 0, 0, 0);
 
   u32 mat_1_tex = gpu_cast(mat_1, gpu_x_f32_t, 0, dim * bytesof(f32));
@@ -203,19 +190,18 @@ i32 main()
   gpu_bind_fbo(0);
   glViewport(0, 0, win_w, win_h);
 
-  let pixels_bytes = dim * bytesof(vec4);
+  let pixels_bytes = dim * bytesof(f32);
 
-  defer(SDLFree) void * pix = SDL_malloc((size_t)pixels_bytes);
+  f32 * out = gpu_malloc(pixels_bytes);
 
-  gpu_get(
-      img_tex, 0, 0, 0, dim_x, dim_y, gpu_rgba_t, gpu_f32_t, pixels_bytes, pix);
+  let fence = gpu_get_mem(
+      img_tex, 0, 0, 0, dim_x, dim_y, gpu_r_t, gpu_f32_t, pixels_bytes, out, 0);
 
-  vec4 * out = pix;
+  gpu_wait(fence);
 
   char print_str[10000] = {};
   SDL_snprintf(
-      print_str, 10000, "pixels[%d].rgba: %f %f %f %f\n", dim - 1,
-      out[dim - 1].x, out[dim - 1].y, out[dim - 1].z, out[dim - 1].w);
+      print_str, 10000, "pixels[%d].r: %f\n", dim - 1, out[dim - 1]);
 
   SDL_ShowSimpleMessageBox(
       SDL_MESSAGEBOX_INFORMATION, "Completed", print_str, NULL);
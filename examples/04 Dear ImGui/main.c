@@ -10,6 +10,10 @@ int32_t main()
 
   imgui_init();
 
+  char * pref_path = SDL_GetPrefPath("gpulib", "Dear ImGui");
+  imgui_font_cache(pref_path);
+  SDL_free(pref_path);
+
   struct ImGuiIO * io = igGetIO();
   struct ImGuiStyle * style = igGetStyle();
 
@@ -76,7 +80,12 @@ int32_t main()
     static bool show_test_window = true;
     igShowTestWindow(&show_test_window);
 
+    static bool show_gpu_prof = true;
+    imgui_gpu_prof_panel(&show_gpu_prof);
+
+    gpu_prof_begin("igRender");
     igRender();
+    gpu_prof_end();
 
     gpu_swap(sdl_window);
 
@@ -0,0 +1,295 @@
+#define RELEASE
+#include "../../gpulib.h"
+#include "../../gl_mock.h"
+#include <stdio.h>
+
+// Times gpu_draw and gpu_draw_sorted on synthetic op lists and prints the
+// results as JSON. Runs on a headless EGL context (Mesa llvmpipe works) or,
+// with --mock, on gl_mock.h to measure the library's own CPU cost.
+//
+// --ops=N     ops per list
+// --cmds=N    commands per op
+// --states=N  distinct ppo, texture and sampler sets
+// --share=F   fraction of ops reusing the ppo, textures and samplers of the
+//             previous op
+// --churn=F   fraction of ops changing the id uniform
+// --frames=N  timed submissions per path
+// --seed=N    seed of the op list generator
+// --mock      use gl_mock.h instead of a GL driver
+
+#define STATES_MAX 256
+
+static uint64_t rng_state = 88172645463325252ull;
+
+static double rng_f64()
+{
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 7;
+  rng_state ^= rng_state << 17;
+  return (double)(rng_state >> 11) / 9007199254740992.0;
+}
+
+static int32_t rng_i32(int32_t n)
+{
+  int32_t i = (int32_t)(rng_f64() * (double)n);
+  return i < n ? i : n - 1;
+}
+
+static int cmp_u64(const void * _Nonnull a, const void * _Nonnull b)
+{
+  uint64_t x = *(const uint64_t *)a;
+  uint64_t y = *(const uint64_t *)b;
+  return x < y ? -1 : x > y ? 1 : 0;
+}
+
+static void print_path(
+    const char * _Nonnull name, uint64_t * _Nonnull ns, int32_t frames,
+    int32_t ops_count, int32_t cmds_count, bool is_mock, bool is_last)
+{
+  SDL_qsort(ns, (size_t)frames, sizeof(uint64_t), cmp_u64);
+
+  double median = (double)ns[frames / 2];
+  double total = 0;
+  for (int32_t i = 0; i < frames; ++i)
+    total += (double)ns[i];
+
+  printf("    {\n");
+  printf("      \"path\": \"%s\",\n", name);
+  printf("      \"ns_per_frame_min\": %.1f,\n", (double)ns[0]);
+  printf("      \"ns_per_frame_median\": %.1f,\n", median);
+  printf("      \"ns_per_frame_mean\": %.1f,\n", total / (double)frames);
+  printf("      \"ns_per_op_median\": %.3f,\n", median / (double)ops_count);
+  printf(
+      "      \"ns_per_cmd_median\": %.3f%s\n",
+      median / (double)(ops_count * cmds_count), is_mock ? "," : "");
+
+  if (is_mock)
+  {
+    printf("      \"calls_per_frame\": {\n");
+    printf(
+        "        \"glBindTextures\": %llu,\n",
+        (unsigned long long)gpu_mock_count(gpu_mock_glBindTextures_t));
+    printf(
+        "        \"glBindSamplers\": %llu,\n",
+        (unsigned long long)gpu_mock_count(gpu_mock_glBindSamplers_t));
+    printf(
+        "        \"glBindProgramPipeline\": %llu,\n",
+        (unsigned long long)gpu_mock_count(gpu_mock_glBindProgramPipeline_t));
+    printf(
+        "        \"glProgramUniform1iv\": %llu,\n",
+        (unsigned long long)gpu_mock_count(gpu_mock_glProgramUniform1iv_t));
+    printf(
+        "        \"glDrawArraysInstancedBaseInstance\": %llu,\n",
+        (unsigned long long)gpu_mock_count(
+            gpu_mock_glDrawArraysInstancedBaseInstance_t));
+    printf(
+        "        \"glMultiDrawArraysIndirect\": %llu\n",
+        (unsigned long long)gpu_mock_count(
+            gpu_mock_glMultiDrawArraysIndirect_t));
+    printf("      }\n");
+  }
+
+  printf("    }%s\n", is_last ? "" : ",");
+}
+
+int32_t main(int32_t argc, char * _Nonnull * _Nonnull argv)
+{
+  int32_t ops_count = 1000;
+  int32_t cmds_count = 1;
+  int32_t states_count = 16;
+  double share = 0.5;
+  double churn = 1.0;
+  int32_t frames = 200;
+  bool is_mock = false;
+
+  for (int32_t i = 1; i < argc; ++i)
+  {
+    const char * arg = argv[i];
+
+    if (SDL_strncmp(arg, "--ops=", 6) == 0)
+      ops_count = SDL_atoi(arg + 6);
+    else if (SDL_strncmp(arg, "--cmds=", 7) == 0)
+      cmds_count = SDL_atoi(arg + 7);
+    else if (SDL_strncmp(arg, "--states=", 9) == 0)
+      states_count = SDL_atoi(arg + 9);
+    else if (SDL_strncmp(arg, "--share=", 8) == 0)
+      share = SDL_atof(arg + 8);
+    else if (SDL_strncmp(arg, "--churn=", 8) == 0)
+      churn = SDL_atof(arg + 8);
+    else if (SDL_strncmp(arg, "--frames=", 9) == 0)
+      frames = SDL_atoi(arg + 9);
+    else if (SDL_strncmp(arg, "--seed=", 7) == 0)
+      rng_state += (uint64_t)SDL_atoi(arg + 7);
+    else if (SDL_strcmp(arg, "--mock") == 0)
+      is_mock = true;
+    else
+    {
+      fprintf(stderr, "Unknown argument: %s\n", arg);
+      return 1;
+    }
+  }
+
+  if (ops_count < 1 || cmds_count < 1 || frames < 1 || states_count < 1 ||
+      states_count > STATES_MAX)
+  {
+    fprintf(stderr, "Invalid arguments\n");
+    return 1;
+  }
+
+  uint32_t error = is_mock ? gpu_load(gpu_mock_get_proc_address)
+                           : gpu_headless(0, NULL, NULL);
+
+  if (error)
+  {
+    fprintf(stderr, "Can't create an OpenGL context\n");
+    return 1;
+  }
+
+  uint32_t vert[STATES_MAX] = {};
+  uint32_t frag[STATES_MAX] = {};
+  uint32_t ppo[STATES_MAX] = {};
+  uint32_t tex[STATES_MAX][2] = {};
+  uint32_t smp[STATES_MAX][2] = {};
+
+  for (int32_t i = 0; i < states_count; ++i)
+  {
+    char vert_string[2048] = {};
+    char frag_string[2048] = {};
+
+    SDL_snprintf(
+        vert_string, sizeof(vert_string),
+        "%s layout(location = 0) uniform int id;                        \n"
+        "                                                               \n"
+        " void main()                                                   \n"
+        " {                                                             \n"
+        "   vec2 pos = vec2(gl_VertexID & 1, gl_VertexID >> 1) / 64.0;  \n"
+        "   pos += vec2(id %% 61, (id / 61 + %d) %% 61) / 32.0 - 1.0;   \n"
+        "   gl_Position = vec4(pos, 0, 1);                              \n"
+        " }                                                             \n",
+        gpu_vert_head, i);
+
+    SDL_snprintf(
+        frag_string, sizeof(frag_string),
+        "%s layout(location = 0) uniform int id;                        \n"
+        " layout(binding = 0) uniform sampler2DArray s_tex_0;           \n"
+        " layout(binding = 1) uniform sampler2DArray s_tex_1;           \n"
+        "                                                               \n"
+        " out vec4 color;                                               \n"
+        "                                                               \n"
+        " void main()                                                   \n"
+        " {                                                             \n"
+        "   vec3 uv = vec3(0.5, 0.5, 0);                                \n"
+        "   color = texture(s_tex_0, uv) + texture(s_tex_1, uv);        \n"
+        "   color.a = float(id + %d);                                   \n"
+        " }                                                             \n",
+        gpu_frag_head, i);
+
+    vert[i] = gpu_vert(vert_string);
+    frag[i] = gpu_frag(frag_string);
+    ppo[i] = gpu_ppo(vert[i], frag[i]);
+
+    for (int32_t j = 0; j < 2; ++j)
+    {
+      tex[i][j] = gpu_malloc_img(gpu_rgba_b8_t, 4, 4, 1, 1);
+      smp[i][j] = gpu_smp(
+          1, j ? gpu_nearest_t : gpu_linear_t, gpu_linear_t,
+          gpu_clamp_to_edge_t);
+    }
+  }
+
+  uint32_t color_tex = gpu_malloc_img(gpu_rgba_b8_t, 64, 64, 1, 1);
+  uint32_t fbo = gpu_fbo(color_tex, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+
+  struct gpu_cmd_t * cmd =
+      SDL_malloc((size_t)cmds_count * sizeof(struct gpu_cmd_t));
+  struct gpu_ops_t * ops =
+      SDL_malloc((size_t)ops_count * sizeof(struct gpu_ops_t));
+  uint64_t * ns = SDL_malloc((size_t)frames * sizeof(uint64_t));
+
+  if (cmd == NULL || ops == NULL || ns == NULL)
+    return 1;
+
+  for (int32_t i = 0; i < cmds_count; ++i)
+  {
+    cmd[i].count = 3;
+    cmd[i].instance_count = 1;
+    cmd[i].first = 0;
+    cmd[i].instance_first = i;
+  }
+
+  int32_t state = 0;
+  int32_t id = 0;
+
+  for (int32_t i = 0; i < ops_count; ++i)
+  {
+    if (i == 0 || rng_f64() >= share)
+      state = rng_i32(states_count);
+
+    if (i == 0 || rng_f64() < churn)
+      id += 1;
+
+    ops[i].id = id;
+    ops[i].tex_first = 0;
+    ops[i].tex_count = 2;
+    ops[i].smp_first = 0;
+    ops[i].smp_count = 2;
+    ops[i].tex = tex[state];
+    ops[i].smp = smp[state];
+    ops[i].vert = vert[state];
+    ops[i].frag = frag[state];
+    ops[i].ppo = ppo[state];
+    ops[i].mode = gpu_triangles_t;
+    ops[i].cmd_count = cmds_count;
+    ops[i].cmd = cmd;
+  }
+
+  gpu_bind_fbo(fbo);
+  glViewport(0, 0, 64, 64);
+
+  printf("{\n");
+  printf("  \"benchmark\": \"gpu_draw\",\n");
+  printf("  \"backend\": \"%s\",\n", is_mock ? "mock" : "gl");
+  printf("  \"renderer\": \"%s\",\n", glGetString(7937)); // GL_RENDERER
+  printf("  \"ops\": %d,\n", ops_count);
+  printf("  \"cmds_per_op\": %d,\n", cmds_count);
+  printf("  \"states\": %d,\n", states_count);
+  printf("  \"share\": %.3f,\n", share);
+  printf("  \"churn\": %.3f,\n", churn);
+  printf("  \"frames\": %d,\n", frames);
+  printf("  \"results\": [\n");
+
+  for (int32_t path = 0; path < 2; ++path)
+  {
+    for (int32_t frame = -10; frame < frames; ++frame)
+    {
+      gpu_clear();
+
+      if (is_mock)
+        gpu_mock_reset();
+
+      uint64_t t0 = SDL_GetPerformanceCounter();
+
+      if (path == 0)
+        gpu_draw(ops_count, ops);
+      else
+        gpu_draw_sorted(ops_count, ops, NULL);
+
+      uint64_t t1 = SDL_GetPerformanceCounter();
+
+      glFinish();
+
+      if (frame >= 0)
+        ns[frame] = (uint64_t)(
+            (double)(t1 - t0) * 1e9 / (double)SDL_GetPerformanceFrequency());
+    }
+
+    print_path(
+        path == 0 ? "gpu_draw" : "gpu_draw_sorted", ns, frames, ops_count,
+        cmds_count, is_mock, path == 1);
+  }
+
+  printf("  ]\n");
+  printf("}\n");
+
+  return 0;
+}
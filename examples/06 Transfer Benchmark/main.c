@@ -0,0 +1,419 @@
+#define RELEASE
+#include "../../gpulib.h"
+#include <stdio.h>
+
+// Measures how fast data moves through gpulib's I/O paths on a headless EGL
+// context and prints one JSON record per path, format and size:
+//
+// cpu_write     CPU memcpy into gpu_malloc memory
+// xfb_write     transform feedback filling gpu_malloc memory, fence included
+// cpu_read_xfb  CPU reading back what transform feedback wrote
+// gpu_cast      texture buffer view creation
+// gpu_set       upload from CPU memory, glFinish included
+// gpu_set_mem   upload from gpu_malloc memory, fence included
+// gpu_get       readback into CPU memory
+// gpu_get_mem   readback into gpu_malloc memory, fence included
+//
+// Texture paths run every format and pixel type pair gpu_pixel_check
+// accepts with as many components as the texture format, --all-combos drops
+// the component match. Texture sizes are clamped to GL_MAX_TEXTURE_SIZE,
+// "bytes" is what was actually moved.
+//
+// --min-bytes=N  first size of the sweep, 4 KiB by default
+// --max-bytes=N  last size of the sweep, 1 GiB by default, sizes grow 4x
+// --reps=N       minimum timed repetitions per record
+// --path=NAME    run only one path
+// --format=NAME  run only one texture format, e.g. gpu_rgba_b8_t
+// --all-combos   also run pixel formats converting between component counts
+
+struct name_t
+{
+  uint32_t value;
+  int32_t size;
+  const char * _Nonnull name;
+};
+
+#define NAME(value, size) {value, size, #value}
+
+// size: component count
+static const struct name_t tex_formats[] = {
+    NAME(gpu_d_b16_t, 1),         NAME(gpu_d_f32_t, 1),
+    NAME(gpu_ds_b24_u8_t, 1),     NAME(gpu_r_b8_t, 1),
+    NAME(gpu_r_f16_t, 1),         NAME(gpu_r_f32_t, 1),
+    NAME(gpu_r_i32_t, 1),         NAME(gpu_r_u32_t, 1),
+    NAME(gpu_rg_f16_t, 2),        NAME(gpu_rg_f32_t, 2),
+    NAME(gpu_rg_i32_t, 2),        NAME(gpu_rg_u32_t, 2),
+    NAME(gpu_rgb_b8_t, 3),        NAME(gpu_rgb_f11f11f10_t, 3),
+    NAME(gpu_rgba_b8_t, 4),       NAME(gpu_rgba_b10b10b10b2_t, 4),
+    NAME(gpu_srgb_b8_t, 3),       NAME(gpu_srgba_b8_t, 4),
+    NAME(gpu_rgba_f32_t, 4),      NAME(gpu_rgba_i32_t, 4),
+    NAME(gpu_rgba_u32_t, 4)};
+
+// size: component count
+static const struct name_t pixel_formats[] = {
+    NAME(gpu_d_t, 1),       NAME(gpu_ds_t, 1),     NAME(gpu_r_t, 1),
+    NAME(gpu_rg_t, 2),      NAME(gpu_rgb_t, 3),    NAME(gpu_bgr_t, 3),
+    NAME(gpu_rgba_t, 4),    NAME(gpu_bgra_t, 4),   NAME(gpu_r_int_t, 1),
+    NAME(gpu_rg_int_t, 2),  NAME(gpu_rgb_int_t, 3), NAME(gpu_rgba_int_t, 4)};
+
+// size: bytes per component, 0 for types packing a pixel into 32 bits
+static const struct name_t pixel_types[] = {
+    NAME(gpu_i8_t, 1),        NAME(gpu_i16_t, 2),
+    NAME(gpu_i32_t, 4),       NAME(gpu_u8_t, 1),
+    NAME(gpu_u16_t, 2),       NAME(gpu_u32_t, 4),
+    NAME(gpu_f16_t, 2),       NAME(gpu_f32_t, 4),
+    NAME(gpu_f11f11f10_t, 0), NAME(gpu_b10b10b10b2_t, 0),
+    NAME(gpu_u24u8_t, 0)};
+
+#define REPS_MAX 256
+
+static int32_t reps_min = 5;
+static bool is_first_record = true;
+
+static double now_ms()
+{
+  return (double)SDL_GetPerformanceCounter() * 1000.0 /
+         (double)SDL_GetPerformanceFrequency();
+}
+
+static int cmp_f64(const void * _Nonnull a, const void * _Nonnull b)
+{
+  double x = *(const double *)a;
+  double y = *(const double *)b;
+  return x < y ? -1 : x > y ? 1 : 0;
+}
+
+// Small transfers are repeated until about 256 MiB moved, at most REPS_MAX
+static int32_t reps_for(ptrdiff_t bytes)
+{
+  ptrdiff_t reps = ((ptrdiff_t)256 << 20) / (bytes > 0 ? bytes : 1);
+  reps = reps > REPS_MAX ? REPS_MAX : reps;
+  return reps > reps_min ? (int32_t)reps : reps_min;
+}
+
+static void print_record(
+    const char * _Nonnull path, const char * _Nullable tex_format,
+    const char * _Nullable pixel_format, const char * _Nullable pixel_type,
+    ptrdiff_t bytes, double * _Nonnull ms, int32_t reps)
+{
+  SDL_qsort(ms, (size_t)reps, sizeof(double), cmp_f64);
+
+  double median = ms[reps / 2];
+
+  printf("%s    {\"path\": \"%s\"", is_first_record ? "" : ",\n", path);
+  if (tex_format)
+    printf(", \"tex_format\": \"%s\"", tex_format);
+  if (pixel_format)
+    printf(", \"pixel_format\": \"%s\"", pixel_format);
+  if (pixel_type)
+    printf(", \"pixel_type\": \"%s\"", pixel_type);
+  printf(
+      ", \"bytes\": %td, \"reps\": %d, \"ms_min\": %.4f, \"ms_median\": %.4f, "
+      "\"gb_per_s\": %.3f}",
+      bytes, reps, ms[0], median,
+      median > 0 ? (double)bytes / (median * 1e6) : 0.0);
+  fflush(stdout);
+
+  is_first_record = false;
+}
+
+static void run_buffer_paths(
+    ptrdiff_t bytes, const char * _Nullable only_path, uint32_t xfb_ppo)
+{
+  static double ms[REPS_MAX];
+  int32_t reps = reps_for(bytes);
+
+  uint8_t * src = SDL_malloc((size_t)bytes);
+  uint32_t * mem = gpu_malloc(bytes);
+
+  if (src == NULL || mem == NULL)
+  {
+    SDL_free(src);
+    gpu_free(mem);
+    fprintf(stderr, "Can't allocate %td bytes\n", bytes);
+    return;
+  }
+
+  SDL_memset(src, 1, (size_t)bytes);
+
+  if (only_path == NULL || SDL_strcmp(only_path, "cpu_write") == 0)
+  {
+    for (int32_t i = -1; i < reps; ++i)
+    {
+      double t = now_ms();
+      SDL_memcpy(mem, src, (size_t)bytes);
+      if (i >= 0)
+        ms[i] = now_ms() - t;
+    }
+    print_record("cpu_write", NULL, NULL, NULL, bytes, ms, reps);
+  }
+
+  bool is_xfb_write =
+      only_path == NULL || SDL_strcmp(only_path, "xfb_write") == 0;
+  bool is_cpu_read_xfb =
+      only_path == NULL || SDL_strcmp(only_path, "cpu_read_xfb") == 0;
+
+  if (is_xfb_write || is_cpu_read_xfb)
+  {
+    uint32_t xfb = gpu_xfb(mem, 0, bytes, NULL, 0, 0, NULL, 0, 0, NULL, 0, 0);
+
+    struct gpu_cmd_t cmd = {};
+    cmd.count = (int32_t)(bytes / 4);
+    cmd.instance_count = 1;
+
+    struct gpu_ops_t ops = {};
+    ops.ppo = xfb_ppo;
+    ops.mode = gpu_points_t;
+    ops.cmd_count = 1;
+    ops.cmd = &cmd;
+
+    static double read_ms[REPS_MAX];
+    volatile uint32_t sink = 0;
+
+    for (int32_t i = -1; i < reps; ++i)
+    {
+      double t = now_ms();
+      glEnable(35977); // GL_RASTERIZER_DISCARD
+      gpu_bind_xfb(xfb);
+      gpu_draw_xfb(1, &ops);
+      gpu_bind_xfb(0);
+      glDisable(35977); // GL_RASTERIZER_DISCARD
+      gpu_wait(gpu_fence());
+      double t_read = now_ms();
+
+      uint32_t sum = 0;
+      for (ptrdiff_t j = 0; j < bytes / 4; ++j)
+        sum += mem[j];
+      sink = sink + sum;
+
+      if (i >= 0)
+      {
+        ms[i] = t_read - t;
+        read_ms[i] = now_ms() - t_read;
+      }
+    }
+
+    if (is_xfb_write)
+      print_record("xfb_write", NULL, NULL, NULL, bytes, ms, reps);
+    if (is_cpu_read_xfb)
+      print_record("cpu_read_xfb", NULL, NULL, NULL, bytes, read_ms, reps);
+
+    glDeleteTransformFeedbacks(1, &xfb);
+  }
+
+  if (only_path == NULL || SDL_strcmp(only_path, "gpu_cast") == 0)
+  {
+    for (int32_t i = -1; i < reps; ++i)
+    {
+      double t = now_ms();
+      uint32_t tex = gpu_cast(mem, gpu_x_f32_t, 0, bytes);
+      if (i >= 0)
+        ms[i] = now_ms() - t;
+      glDeleteTextures(1, &tex);
+    }
+    print_record("gpu_cast", "gpu_x_f32_t", NULL, NULL, bytes, ms, reps);
+  }
+
+  gpu_free(mem);
+  SDL_free(src);
+}
+
+static void run_tex_paths(
+    ptrdiff_t bytes, const char * _Nullable only_path,
+    const char * _Nullable only_format, bool is_all_combos, int32_t max_size)
+{
+  static double ms[REPS_MAX];
+
+  const char * paths[] = {"gpu_set", "gpu_set_mem", "gpu_get", "gpu_get_mem"};
+
+  // Small sizes still move a 16 pixel row of up to 16 byte pixels
+  ptrdiff_t capacity = bytes > 16 * 16 ? bytes : 16 * 16;
+
+  uint8_t * host = SDL_malloc((size_t)capacity);
+  void * mem = gpu_malloc(capacity);
+
+  if (host == NULL || mem == NULL)
+  {
+    SDL_free(host);
+    gpu_free(mem);
+    fprintf(stderr, "Can't allocate %td bytes\n", capacity);
+    return;
+  }
+
+  SDL_memset(host, 0, (size_t)capacity);
+
+  for (size_t f = 0; f < sizeof(tex_formats) / sizeof(tex_formats[0]); ++f)
+  {
+    const struct name_t * tex_format = &tex_formats[f];
+
+    if (only_format && SDL_strcmp(only_format, tex_format->name) != 0)
+      continue;
+
+    for (size_t pf = 0; pf < sizeof(pixel_formats) / sizeof(pixel_formats[0]);
+         ++pf)
+    {
+      const struct name_t * pixel_format = &pixel_formats[pf];
+
+      if (!is_all_combos && pixel_format->size != tex_format->size)
+        continue;
+
+      for (size_t pt = 0; pt < sizeof(pixel_types) / sizeof(pixel_types[0]);
+           ++pt)
+      {
+        const struct name_t * pixel_type = &pixel_types[pt];
+
+        if (!gpu_pixel_check(
+                tex_format->value, (enum gpu_pixel_format_t)pixel_format->value,
+                (enum gpu_pixel_t)pixel_type->value))
+          continue;
+
+        ptrdiff_t pixel_bytes =
+            pixel_type->size ? pixel_type->size * pixel_format->size : 4;
+
+        // Power of two width, at least 16 pixels so rows stay 4-aligned
+        ptrdiff_t pixels = bytes / pixel_bytes;
+        ptrdiff_t width = 16;
+        while (width * width * 2 <= pixels && width * 2 <= max_size)
+          width *= 2;
+        ptrdiff_t height = pixels / width;
+        height = height < 1 ? 1 : height > max_size ? max_size : height;
+        ptrdiff_t moved = width * height * pixel_bytes;
+
+        uint32_t tex = gpu_malloc_img(
+            (enum gpu_tex_format_t)tex_format->value, (int32_t)width,
+            (int32_t)height, 1, 1);
+
+        int32_t reps = reps_for(moved);
+
+        for (int32_t p = 0; p < 4; ++p)
+        {
+          if (only_path && SDL_strcmp(only_path, paths[p]) != 0)
+            continue;
+
+          for (int32_t i = -1; i < reps; ++i)
+          {
+            double t = now_ms();
+
+            enum gpu_pixel_format_t format =
+                (enum gpu_pixel_format_t)pixel_format->value;
+            enum gpu_pixel_t type = (enum gpu_pixel_t)pixel_type->value;
+            int32_t w = (int32_t)width;
+            int32_t h = (int32_t)height;
+
+            if (p == 0)
+            {
+              gpu_set(tex, 0, 0, 0, w, h, format, type, host);
+              glFinish();
+            }
+            else if (p == 1)
+            {
+              gpu_wait(gpu_set_mem(tex, 0, 0, 0, w, h, format, type, mem, 0));
+            }
+            else if (p == 2)
+            {
+              gpu_get(tex, 0, 0, 0, w, h, format, type, moved, host);
+            }
+            else
+            {
+              gpu_wait(
+                  gpu_get_mem(tex, 0, 0, 0, w, h, format, type, moved, mem, 0));
+            }
+
+            if (i >= 0)
+              ms[i] = now_ms() - t;
+          }
+
+          print_record(
+              paths[p], tex_format->name, pixel_format->name, pixel_type->name,
+              moved, ms, reps);
+        }
+
+        glDeleteTextures(1, &tex);
+      }
+    }
+  }
+
+  gpu_free(mem);
+  SDL_free(host);
+}
+
+int32_t main(int32_t argc, char * _Nonnull * _Nonnull argv)
+{
+  ptrdiff_t min_bytes = (ptrdiff_t)4 << 10;
+  ptrdiff_t max_bytes = (ptrdiff_t)1 << 30;
+  const char * only_path = NULL;
+  const char * only_format = NULL;
+  bool is_all_combos = false;
+
+  for (int32_t i = 1; i < argc; ++i)
+  {
+    const char * arg = argv[i];
+
+    if (SDL_strncmp(arg, "--min-bytes=", 12) == 0)
+      min_bytes = (ptrdiff_t)SDL_strtoll(arg + 12, NULL, 10);
+    else if (SDL_strncmp(arg, "--max-bytes=", 12) == 0)
+      max_bytes = (ptrdiff_t)SDL_strtoll(arg + 12, NULL, 10);
+    else if (SDL_strncmp(arg, "--reps=", 7) == 0)
+      reps_min = SDL_atoi(arg + 7);
+    else if (SDL_strncmp(arg, "--path=", 7) == 0)
+      only_path = arg + 7;
+    else if (SDL_strncmp(arg, "--format=", 9) == 0)
+      only_format = arg + 9;
+    else if (SDL_strcmp(arg, "--all-combos") == 0)
+      is_all_combos = true;
+    else
+    {
+      fprintf(stderr, "Unknown argument: %s\n", arg);
+      return 1;
+    }
+  }
+
+  if (min_bytes < 16 || max_bytes < min_bytes || reps_min < 1 ||
+      reps_min > REPS_MAX)
+  {
+    fprintf(stderr, "Invalid arguments\n");
+    return 1;
+  }
+
+  if (gpu_headless(0, NULL, NULL))
+  {
+    fprintf(stderr, "Can't create an OpenGL context\n");
+    return 1;
+  }
+
+  int32_t max_size = 0;
+  glGetIntegerv(3379, &max_size); // GL_MAX_TEXTURE_SIZE
+
+  uint32_t xfb_vert = gpu_vert_xfb(
+      gpu_vert_head " out uint value;                                    \n"
+                    "                                                    \n"
+                    " void main()                                        \n"
+                    " {                                                  \n"
+                    "   value = uint(gl_VertexID) * 2654435761u;         \n"
+                    " }                                                  \n",
+      1, (const char * _Nullable[]){"value"});
+  uint32_t xfb_ppo = gpu_ppo(xfb_vert, 0);
+
+  // Headless contexts have no default framebuffer to draw to, even with
+  // rasterization discarded
+  uint32_t color_tex = gpu_malloc_img(gpu_rgba_b8_t, 1, 1, 1, 1);
+  uint32_t fbo = gpu_fbo(color_tex, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+  gpu_bind_fbo(fbo);
+
+  printf("{\n");
+  printf("  \"benchmark\": \"transfer\",\n");
+  printf("  \"renderer\": \"%s\",\n", glGetString(7937)); // GL_RENDERER
+  printf("  \"max_texture_size\": %d,\n", max_size);
+  printf("  \"results\": [\n");
+
+  for (ptrdiff_t bytes = min_bytes; bytes <= max_bytes; bytes *= 4)
+  {
+    run_buffer_paths(bytes, only_path, xfb_ppo);
+    run_tex_paths(bytes, only_path, only_format, is_all_combos, max_size);
+  }
+
+  printf("\n  ]\n");
+  printf("}\n");
+
+  return 0;
+}
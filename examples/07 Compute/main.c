@@ -0,0 +1,394 @@
+#include "../../gpulib_compute.h"
+#include <stdio.h>
+
+// Runs the gpulib_compute.h primitives on a headless EGL context, checks
+// them against the CPU and prints one line per primitive.
+//
+// --count=N  elements per array
+
+static double now_ms()
+{
+  return (double)SDL_GetPerformanceCounter() * 1000.0 /
+         (double)SDL_GetPerformanceFrequency();
+}
+
+static void print_result(const char * _Nonnull name, bool is_ok, double ms)
+{
+  printf("%-24s %s %10.3f ms\n", name, is_ok ? "ok  " : "FAIL", ms);
+}
+
+// Builds and runs count gpu_map programs never used again
+static bool fill_cache(int32_t count, float * _Nonnull out)
+{
+  static int32_t id = 0;
+  bool is_ok = true;
+
+  for (int32_t i = 0; i < count; ++i, ++id)
+  {
+    char expr[64] = {};
+    SDL_snprintf(expr, sizeof(expr), "float(i + %d)", id);
+    gpu_wait(gpu_map(expr, 1, out, gpu_x_f32_t, 0, 0, NULL));
+    is_ok = is_ok && out[0] == (float)id;
+  }
+
+  return is_ok;
+}
+
+int32_t main(int32_t argc, char * _Nonnull * _Nonnull argv)
+{
+  int32_t count = 1000000;
+
+  for (int32_t i = 1; i < argc; ++i)
+  {
+    const char * arg = argv[i];
+
+    if (SDL_strncmp(arg, "--count=", 8) == 0)
+      count = SDL_atoi(arg + 8);
+    else
+    {
+      fprintf(stderr, "Unknown argument: %s\n", arg);
+      return 1;
+    }
+  }
+
+  if (count < 1)
+  {
+    fprintf(stderr, "Invalid arguments\n");
+    return 1;
+  }
+
+  if (gpu_headless(0, NULL, NULL))
+  {
+    fprintf(stderr, "Can't create an OpenGL context\n");
+    return 1;
+  }
+
+  float * a = gpu_malloc((ptrdiff_t)count * 4);
+  float * b = gpu_malloc((ptrdiff_t)count * 8);
+  float * c = gpu_malloc((ptrdiff_t)count * 4);
+  uint32_t * u = gpu_malloc((ptrdiff_t)count * 4);
+
+  if (a == NULL || b == NULL || c == NULL || u == NULL)
+  {
+    fprintf(stderr, "Can't allocate %d elements\n", count);
+    return 1;
+  }
+
+  for (int32_t i = 0; i < count; ++i)
+  {
+    a[i] = (float)(i % 1000) * 0.5f;
+    b[i * 2 + 0] = (float)(i % 7);
+    b[i * 2 + 1] = (float)(i % 13);
+  }
+
+  {
+    struct gpu_map_in_t in[] = {
+        {a, gpu_x_f32_t, 0},
+        {b, gpu_xy_f32_t, 0},
+    };
+
+    double t = now_ms();
+    gpu_wait(gpu_map("i0 * i1.x + i1.y", count, c, gpu_x_f32_t, 0, 2, in));
+    t = now_ms() - t;
+
+    bool is_ok = true;
+    for (int32_t i = 0; i < count; ++i)
+      is_ok = is_ok && c[i] == a[i] * b[i * 2 + 0] + b[i * 2 + 1];
+
+    print_result("gpu_map f32", is_ok, t);
+  }
+
+  {
+    double t = now_ms();
+    gpu_wait(
+        gpu_map("uint(i) * 2654435761u", count, u, gpu_x_u32_t, 0, 0, NULL));
+    t = now_ms() - t;
+
+    bool is_ok = true;
+    for (int32_t i = 0; i < count; ++i)
+      is_ok = is_ok && u[i] == (uint32_t)i * 2654435761u;
+
+    print_result("gpu_map u32", is_ok, t);
+  }
+
+  for (int32_t i = 0; i < count; ++i)
+  {
+    a[i] = (float)(((int64_t)i * 7919) % 10007) - 5000.0f;
+    u[i] = (uint32_t)(((int64_t)i * 104729) % 1000003);
+  }
+
+  {
+    const char * names[] = {"sum", "min", "max", "argmin", "argmax", "mean"};
+    enum gpu_reduce_t ops[] = {gpu_sum_t,    gpu_min_t,    gpu_max_t,
+                               gpu_argmin_t, gpu_argmax_t, gpu_mean_t};
+
+    for (int32_t k = 0; k < 2; ++k)
+    {
+      // CPU reference in double, min/max and args keep the first index
+      double sum = 0;
+      double lo = 0;
+      double hi = 0;
+      int32_t lo_index = 0;
+      int32_t hi_index = 0;
+
+      for (int32_t i = 0; i < count; ++i)
+      {
+        double x = k == 0 ? (double)a[i] : (double)u[i];
+        sum += x;
+        if (i == 0 || x < lo)
+        {
+          lo = x;
+          lo_index = i;
+        }
+        if (i == 0 || x > hi)
+        {
+          hi = x;
+          hi_index = i;
+        }
+      }
+
+      // u32 sums wrap, means don't
+      double wrapped = k == 1 ? (double)(uint32_t)(uint64_t)sum : sum;
+
+      double expected[] = {wrapped, lo, hi, lo, hi, sum / (double)count};
+      int32_t expected_index[] = {-1, -1, -1, lo_index, hi_index, -1};
+
+      for (int32_t j = 0; j < 6; ++j)
+      {
+        double value = 0;
+        int32_t index = 0;
+
+        void * mem = k == 0 ? (void *)a : (void *)u;
+        enum gpu_tex_mem_format_t format = k == 0 ? gpu_x_f32_t : gpu_x_u32_t;
+
+        // The first call compiles the passes, time the second one
+        gpu_reduce(ops[j], mem, format, 0, count, &value, &index);
+
+        double t = now_ms();
+        bool is_ok = gpu_reduce(ops[j], mem, format, 0, count, &value, &index);
+        t = now_ms() - t;
+
+        // Float sums are reassociated, compare them relatively
+        double error = value - expected[j];
+        error = error < 0 ? -error : error;
+        double scale = expected[j] < 0 ? -expected[j] : expected[j];
+        is_ok = is_ok && error <= (j == 0 || j == 5 ? 1e-4 * scale + 1e-3 : 0);
+        is_ok = is_ok && index == expected_index[j];
+
+        char name[64] = {};
+        SDL_snprintf(
+            name, sizeof(name), "gpu_reduce %s %s", k == 0 ? "f32" : "u32",
+            names[j]);
+        print_result(name, is_ok, t);
+      }
+    }
+  }
+
+  // Once the program cache is full, a call whose first program is a hit and
+  // whose next one is a miss must not evict the first. Means of f32 and u32
+  // share their next pass program, after a flush and k more programs the
+  // eviction reaches the u32 first pass program right when the shared one
+  // is rebuilt.
+  {
+    int32_t n = count < 10000 ? count : 10000;
+    double sum = 0;
+    for (int32_t i = 0; i < n; ++i)
+      sum += (double)u[i];
+
+    bool is_ok = true;
+    double t = now_ms();
+
+    for (int32_t k = GPU_COMPUTE_CACHE - 3; k <= GPU_COMPUTE_CACHE; ++k)
+    {
+      double v = 0;
+      is_ok = is_ok && fill_cache(GPU_COMPUTE_CACHE, c);
+      is_ok = is_ok && gpu_reduce(gpu_mean_t, a, gpu_x_f32_t, 0, n, &v, NULL);
+      is_ok = is_ok && gpu_reduce(gpu_mean_t, u, gpu_x_u32_t, 0, n, &v, NULL);
+      is_ok = is_ok && fill_cache(k, c);
+      is_ok = is_ok && gpu_reduce(gpu_mean_t, u, gpu_x_u32_t, 0, n, &v, NULL);
+
+      double error = v - sum / (double)n;
+      is_ok = is_ok && error * error <= 1e-6 * v * v;
+    }
+
+    t = now_ms() - t;
+
+    print_result("gpu_reduce cache evict", is_ok, t);
+  }
+
+  {
+    const char * names[] = {"sum", "min", "max"};
+    enum gpu_reduce_t ops[] = {gpu_sum_t, gpu_min_t, gpu_max_t};
+
+    for (int32_t j = 0; j < 6; ++j)
+    {
+      enum gpu_reduce_t op = ops[j % 3];
+      bool is_exclusive = j >= 3;
+
+      gpu_wait(gpu_scan(op, is_exclusive, u, gpu_x_u32_t, 0, count, c, 0));
+
+      double t = now_ms();
+      gpu_wait(gpu_scan(op, is_exclusive, u, gpu_x_u32_t, 0, count, c, 0));
+      t = now_ms() - t;
+
+      uint32_t * scan = (uint32_t *)c;
+      uint32_t v = op == gpu_min_t ? 0xFFFFFFFFu : 0;
+      bool is_ok = true;
+
+      for (int32_t i = 0; i < count; ++i)
+      {
+        if (is_exclusive)
+          is_ok = is_ok && scan[i] == v;
+
+        uint32_t x = u[i];
+        v = op == gpu_sum_t ? v + x
+            : op == gpu_min_t ? (x < v ? x : v)
+                              : (x > v ? x : v);
+
+        if (!is_exclusive)
+          is_ok = is_ok && scan[i] == v;
+      }
+
+      char name[64] = {};
+      SDL_snprintf(
+          name, sizeof(name), "gpu_scan u32 %s %s",
+          is_exclusive ? "excl" : "incl", names[j % 3]);
+      print_result(name, is_ok, t);
+    }
+  }
+
+  // Exclusive scans run a shift 1 program once, then the shift 0 one of
+  // inclusive scans. After a flush, an inclusive and an exclusive scan and
+  // k more programs, the shift 1 program is a hit and the shift 0 one is a
+  // miss that must not evict it.
+  {
+    int32_t n = count < 10000 ? count : 10000;
+    uint32_t * scan = (uint32_t *)c;
+    bool is_ok = true;
+    double t = now_ms();
+
+    for (int32_t k = GPU_COMPUTE_CACHE - 3; k <= GPU_COMPUTE_CACHE; ++k)
+    {
+      is_ok = is_ok && fill_cache(GPU_COMPUTE_CACHE, c);
+      gpu_wait(gpu_scan(gpu_sum_t, false, u, gpu_x_u32_t, 0, n, c, 0));
+      gpu_wait(gpu_scan(gpu_sum_t, true, u, gpu_x_u32_t, 0, n, c, 0));
+      is_ok = is_ok && fill_cache(k, c);
+
+      void * fence = gpu_scan(gpu_sum_t, true, u, gpu_x_u32_t, 0, n, c, 0);
+      gpu_wait(fence);
+      is_ok = is_ok && fence != NULL;
+
+      uint32_t v = 0;
+      for (int32_t i = 0; i < n; ++i)
+      {
+        is_ok = is_ok && scan[i] == v;
+        v += u[i];
+      }
+    }
+
+    t = now_ms() - t;
+
+    print_result("gpu_scan cache evict", is_ok, t);
+  }
+
+  {
+    gpu_compact_count(
+        gpu_compact("i0 < 0.0", a, gpu_x_f32_t, 0, count, c, 0), true);
+
+    double t = now_ms();
+    uint32_t query = gpu_compact("i0 < 0.0", a, gpu_x_f32_t, 0, count, c, 0);
+    int32_t compacted = -1;
+    while (compacted < 0)
+      compacted = gpu_compact_count(query, false);
+    t = now_ms() - t;
+
+    int32_t expected = 0;
+    bool is_ok = query != 0;
+
+    for (int32_t i = 0; i < count; ++i)
+      if (a[i] < 0.0f)
+        is_ok = is_ok && expected < compacted && c[expected++] == a[i];
+
+    print_result("gpu_compact f32", is_ok && compacted == expected, t);
+  }
+
+  {
+    uint32_t * values = (uint32_t *)c;
+
+    for (int32_t j = 0; j < 2; ++j)
+    {
+      for (int32_t i = 0; i < count; ++i)
+      {
+        b[i] = a[i];
+        values[i] = (uint32_t)i;
+      }
+
+      bool is_descending = j == 1;
+
+      double t = now_ms();
+      void * fence =
+          gpu_sort(b, gpu_x_f32_t, 0, values, 0, count, is_descending);
+      gpu_wait(fence);
+      t = now_ms() - t;
+
+      bool is_ok = fence != NULL;
+
+      for (int32_t i = 0; i < count; ++i)
+      {
+        is_ok = is_ok && values[i] < (uint32_t)count && a[values[i]] == b[i];
+        if (i > 0)
+          is_ok = is_ok &&
+                  (is_descending ? b[i - 1] >= b[i] : b[i - 1] <= b[i]);
+      }
+
+      print_result(
+          is_descending ? "gpu_sort f32 desc" : "gpu_sort f32", is_ok, t);
+    }
+  }
+
+  // Ascending and descending sorts share their pack program. After a flush,
+  // an ascending sort and k more programs, a descending sort finds the pack
+  // program and its step program miss must not evict it.
+  {
+    int32_t n = count < 10000 ? count : 10000;
+    uint32_t * values = (uint32_t *)c;
+    bool is_ok = true;
+    double t = now_ms();
+
+    for (int32_t k = GPU_COMPUTE_CACHE - 4; k <= GPU_COMPUTE_CACHE - 1; ++k)
+    {
+      for (int32_t j = 0; j < 2; ++j)
+      {
+        is_ok = is_ok && fill_cache(j == 0 ? GPU_COMPUTE_CACHE : k, c);
+
+        for (int32_t i = 0; i < n; ++i)
+        {
+          b[i] = a[i];
+          values[i] = (uint32_t)i;
+        }
+
+        void * fence = gpu_sort(b, gpu_x_f32_t, 0, values, 0, n, j == 1);
+        gpu_wait(fence);
+        is_ok = is_ok && fence != NULL;
+      }
+
+      for (int32_t i = 0; i < n; ++i)
+      {
+        is_ok = is_ok && values[i] < (uint32_t)n && a[values[i]] == b[i];
+        if (i > 0)
+          is_ok = is_ok && b[i - 1] >= b[i];
+      }
+    }
+
+    t = now_ms() - t;
+
+    print_result("gpu_sort cache evict", is_ok, t);
+  }
+
+  gpu_free(u);
+  gpu_free(c);
+  gpu_free(b);
+  gpu_free(a);
+
+  return 0;
+}
@@ -0,0 +1,385 @@
+#define RELEASE
+#include "../../gpulib_compute.h"
+#include <stdio.h>
+
+// Sorts random 32 bit key / 32 bit value pairs with gpu_sort, std::sort and
+// a multithreaded LSD radix sort on a headless EGL context and prints one
+// JSON record per sorter, key type and count. Values are the original
+// indices, every result is checked against std::sort.
+//
+// gpu_sort    bitonic fragment passes over gpu_malloc keys and values,
+//             fence included
+// std_sort    std::sort over interleaved pairs, std_sort.cpp
+// radix_sort  4 passes of 8 bits, histograms and scatters split over
+//             --threads SDL threads
+//
+// --min-count=N  first count of the sweep, 1 Mi by default
+// --max-count=N  last count of the sweep, 16 Mi by default, counts grow 4x
+// --reps=N       timed repetitions per record
+// --threads=N    radix sort threads, SDL_GetCPUCount() by default
+// --key=NAME     only sort f32, i32 or u32 keys
+// --descending   sort from the largest key
+
+#define REPS_MAX 64
+#define THREADS_MAX 64
+#define RADIX_SIZE 256
+
+struct pair_t
+{
+  uint32_t key;
+  uint32_t value;
+};
+
+void std_sort(
+    struct pair_t * _Nonnull pairs, ptrdiff_t count, int32_t kind,
+    bool is_descending);
+
+struct radix_task_t
+{
+  const struct pair_t * _Nullable src;
+  struct pair_t * _Nullable dst;
+  ptrdiff_t first;
+  ptrdiff_t last;
+  int32_t kind;
+  int32_t shift;
+  bool is_descending;
+  bool is_scatter;
+  ptrdiff_t offsets[RADIX_SIZE];
+};
+
+static const char * _Nonnull key_names[] = {"f32", "i32", "u32"};
+static const enum gpu_tex_mem_format_t key_formats[] = {
+    gpu_x_f32_t, gpu_x_i32_t, gpu_x_u32_t};
+
+static uint64_t rng_state = 88172645463325252ull;
+
+static uint32_t rng_u32()
+{
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 7;
+  rng_state ^= rng_state << 17;
+  return (uint32_t)(rng_state >> 32);
+}
+
+static int cmp_f64(const void * _Nonnull a, const void * _Nonnull b)
+{
+  double x = *(const double *)a;
+  double y = *(const double *)b;
+  return x < y ? -1 : x > y ? 1 : 0;
+}
+
+static double now_ms()
+{
+  return (double)SDL_GetPerformanceCounter() * 1000.0 /
+         (double)SDL_GetPerformanceFrequency();
+}
+
+// Same key order as gpu_sort: floats and ints mapped to uints
+static inline uint32_t radix_digit(
+    uint32_t key, int32_t kind, int32_t shift, bool is_descending)
+{
+  uint32_t u = kind == 0   ? ((key & 0x80000000u) ? ~key : key ^ 0x80000000u)
+               : kind == 1 ? key ^ 0x80000000u
+                           : key;
+
+  return ((is_descending ? ~u : u) >> shift) & (RADIX_SIZE - 1);
+}
+
+static int radix_task(void * _Nullable data)
+{
+  struct radix_task_t * task = data;
+
+  if (task->is_scatter)
+  {
+    for (ptrdiff_t i = task->first; i < task->last; ++i)
+    {
+      struct pair_t pair = task->src[i];
+      uint32_t digit =
+          radix_digit(pair.key, task->kind, task->shift, task->is_descending);
+      task->dst[task->offsets[digit]++] = pair;
+    }
+  }
+  else
+  {
+    SDL_memset(task->offsets, 0, sizeof(task->offsets));
+
+    for (ptrdiff_t i = task->first; i < task->last; ++i)
+      task->offsets[radix_digit(
+          task->src[i].key, task->kind, task->shift, task->is_descending)] += 1;
+  }
+
+  return 0;
+}
+
+static void run_tasks(struct radix_task_t * _Nonnull tasks, int32_t threads)
+{
+  SDL_Thread * thread[THREADS_MAX] = {};
+
+  for (int32_t t = 1; t < threads; ++t)
+    thread[t] = SDL_CreateThread(radix_task, "radix_sort", &tasks[t]);
+
+  radix_task(&tasks[0]);
+
+  for (int32_t t = 1; t < threads; ++t)
+  {
+    if (thread[t])
+      SDL_WaitThread(thread[t], NULL);
+    else
+      radix_task(&tasks[t]);
+  }
+}
+
+static void radix_sort(
+    struct pair_t * _Nonnull pairs, struct pair_t * _Nonnull scratch,
+    ptrdiff_t count, int32_t kind, bool is_descending, int32_t threads)
+{
+  static struct radix_task_t tasks[THREADS_MAX];
+
+  struct pair_t * src = pairs;
+  struct pair_t * dst = scratch;
+
+  for (int32_t shift = 0; shift < 32; shift += 8)
+  {
+    for (int32_t t = 0; t < threads; ++t)
+    {
+      tasks[t].src = src;
+      tasks[t].dst = dst;
+      tasks[t].first = count * t / threads;
+      tasks[t].last = count * (t + 1) / threads;
+      tasks[t].kind = kind;
+      tasks[t].shift = shift;
+      tasks[t].is_descending = is_descending;
+      tasks[t].is_scatter = false;
+    }
+
+    run_tasks(tasks, threads);
+
+    // Each thread scatters its chunk after the previous threads' chunks
+    ptrdiff_t offset = 0;
+
+    for (int32_t digit = 0; digit < RADIX_SIZE; ++digit)
+    {
+      for (int32_t t = 0; t < threads; ++t)
+      {
+        ptrdiff_t digit_count = tasks[t].offsets[digit];
+        tasks[t].offsets[digit] = offset;
+        offset += digit_count;
+      }
+    }
+
+    for (int32_t t = 0; t < threads; ++t)
+      tasks[t].is_scatter = true;
+
+    run_tasks(tasks, threads);
+
+    struct pair_t * swap = src;
+    src = dst;
+    dst = swap;
+  }
+}
+
+static bool is_first_record = true;
+
+static void print_record(
+    const char * _Nonnull sorter, int32_t kind, bool is_descending,
+    int32_t count, double * _Nonnull ms, int32_t reps, bool is_ok)
+{
+  SDL_qsort(ms, (size_t)reps, sizeof(double), cmp_f64);
+
+  double median = ms[reps / 2];
+
+  printf(
+      "%s    {\"sorter\": \"%s\", \"key\": \"%s\", \"order\": \"%s\", "
+      "\"count\": %d, \"reps\": %d, \"ms_min\": %.3f, \"ms_median\": %.3f, "
+      "\"mpairs_per_s\": %.3f, \"ok\": %s}",
+      is_first_record ? "" : ",\n", sorter, key_names[kind],
+      is_descending ? "descending" : "ascending", count, reps, ms[0], median,
+      median > 0 ? (double)count / (median * 1e3) : 0.0,
+      is_ok ? "true" : "false");
+  fflush(stdout);
+
+  is_first_record = false;
+}
+
+static void run_sorters(
+    int32_t count, int32_t kind, bool is_descending, int32_t reps,
+    int32_t threads)
+{
+  static double ms[REPS_MAX];
+
+  size_t bytes = (size_t)count * sizeof(struct pair_t);
+
+  uint32_t * src_keys = SDL_malloc((size_t)count * 4);
+  struct pair_t * expected = SDL_malloc(bytes);
+  struct pair_t * pairs = SDL_malloc(bytes);
+  struct pair_t * scratch = SDL_malloc(bytes);
+  uint32_t * keys = gpu_malloc((ptrdiff_t)count * 4);
+  uint32_t * values = gpu_malloc((ptrdiff_t)count * 4);
+
+  if (src_keys == NULL || expected == NULL || pairs == NULL ||
+      scratch == NULL || keys == NULL || values == NULL)
+  {
+    gpu_free(values);
+    gpu_free(keys);
+    SDL_free(scratch);
+    SDL_free(pairs);
+    SDL_free(expected);
+    SDL_free(src_keys);
+    fprintf(stderr, "Can't allocate %d pairs\n", count);
+    return;
+  }
+
+  // Floats stay finite and never -0, equal keys compare equal bitwise
+  for (int32_t i = 0; i < count; ++i)
+  {
+    uint32_t x = rng_u32();
+
+    if (kind == 0)
+    {
+      float f = (float)(int32_t)x * 1e-3f;
+      SDL_memcpy(&src_keys[i], &f, 4);
+    }
+    else
+      src_keys[i] = x;
+  }
+
+  // std::sort is the reference for the other sorters
+  for (int32_t rep = 0; rep < reps; ++rep)
+  {
+    for (int32_t i = 0; i < count; ++i)
+      expected[i] = (struct pair_t){src_keys[i], (uint32_t)i};
+
+    double t = now_ms();
+    std_sort(expected, count, kind, is_descending);
+    ms[rep] = now_ms() - t;
+  }
+
+  print_record("std_sort", kind, is_descending, count, ms, reps, true);
+
+  bool is_ok = true;
+
+  // The first call compiles the passes
+  for (int32_t rep = -1; rep < reps; ++rep)
+  {
+    SDL_memcpy(keys, src_keys, (size_t)count * 4);
+    for (int32_t i = 0; i < count; ++i)
+      values[i] = (uint32_t)i;
+
+    double t = now_ms();
+    void * fence = gpu_sort(
+        keys, key_formats[kind], 0, values, 0, count, is_descending);
+    gpu_wait(fence);
+    t = now_ms() - t;
+
+    if (rep >= 0)
+      ms[rep] = t;
+
+    is_ok = is_ok && fence != NULL;
+  }
+
+  for (int32_t i = 0; i < count; ++i)
+    is_ok = is_ok && keys[i] == expected[i].key &&
+            values[i] < (uint32_t)count && src_keys[values[i]] == keys[i];
+
+  print_record("gpu_sort", kind, is_descending, count, ms, reps, is_ok);
+
+  is_ok = true;
+
+  for (int32_t rep = 0; rep < reps; ++rep)
+  {
+    for (int32_t i = 0; i < count; ++i)
+      pairs[i] = (struct pair_t){src_keys[i], (uint32_t)i};
+
+    double t = now_ms();
+    radix_sort(pairs, scratch, count, kind, is_descending, threads);
+    ms[rep] = now_ms() - t;
+  }
+
+  for (int32_t i = 0; i < count; ++i)
+    is_ok = is_ok && pairs[i].key == expected[i].key &&
+            src_keys[pairs[i].value] == pairs[i].key;
+
+  print_record("radix_sort", kind, is_descending, count, ms, reps, is_ok);
+
+  gpu_free(values);
+  gpu_free(keys);
+  SDL_free(scratch);
+  SDL_free(pairs);
+  SDL_free(expected);
+  SDL_free(src_keys);
+}
+
+int32_t main(int32_t argc, char * _Nonnull * _Nonnull argv)
+{
+  int32_t min_count = 1 << 20;
+  int32_t max_count = 1 << 24;
+  int32_t reps = 5;
+  int32_t threads = SDL_GetCPUCount();
+  const char * only_key = NULL;
+  bool is_descending = false;
+
+  for (int32_t i = 1; i < argc; ++i)
+  {
+    const char * arg = argv[i];
+
+    if (SDL_strncmp(arg, "--min-count=", 12) == 0)
+      min_count = SDL_atoi(arg + 12);
+    else if (SDL_strncmp(arg, "--max-count=", 12) == 0)
+      max_count = SDL_atoi(arg + 12);
+    else if (SDL_strncmp(arg, "--reps=", 7) == 0)
+      reps = SDL_atoi(arg + 7);
+    else if (SDL_strncmp(arg, "--threads=", 10) == 0)
+      threads = SDL_atoi(arg + 10);
+    else if (SDL_strncmp(arg, "--key=", 6) == 0)
+      only_key = arg + 6;
+    else if (SDL_strcmp(arg, "--descending") == 0)
+      is_descending = true;
+    else
+    {
+      fprintf(stderr, "Unknown argument: %s\n", arg);
+      return 1;
+    }
+  }
+
+  threads = threads < THREADS_MAX ? threads : THREADS_MAX;
+
+  if (min_count < 1 || max_count < min_count || max_count > (1 << 30) ||
+      reps < 1 || reps > REPS_MAX || threads < 1)
+  {
+    fprintf(stderr, "Invalid arguments\n");
+    return 1;
+  }
+
+  if (gpu_headless(0, NULL, NULL))
+  {
+    fprintf(stderr, "Can't create an OpenGL context\n");
+    return 1;
+  }
+
+  int32_t max_size = 0;
+  glGetIntegerv(3379, &max_size); // GL_MAX_TEXTURE_SIZE
+
+  if ((int64_t)max_count > (int64_t)GPU_SORT_WIDTH * max_size)
+  {
+    fprintf(
+        stderr, "gpu_sort sorts up to %lld pairs\n",
+        (long long)GPU_SORT_WIDTH * max_size);
+    return 1;
+  }
+
+  printf("{\n");
+  printf("  \"benchmark\": \"sort\",\n");
+  printf("  \"renderer\": \"%s\",\n", glGetString(7937)); // GL_RENDERER
+  printf("  \"threads\": %d,\n", threads);
+  printf("  \"results\": [\n");
+
+  for (int64_t count = min_count; count <= max_count; count *= 4)
+    for (int32_t kind = 0; kind < 3; ++kind)
+      if (only_key == NULL || SDL_strcmp(only_key, key_names[kind]) == 0)
+        run_sorters((int32_t)count, kind, is_descending, reps, threads);
+
+  printf("\n  ]\n");
+  printf("}\n");
+
+  return 0;
+}
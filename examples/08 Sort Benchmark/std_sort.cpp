@@ -0,0 +1,44 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// std::sort baseline for main.c, gpulib.h itself is C only
+
+struct pair_t
+{
+  uint32_t key;
+  uint32_t value;
+};
+
+template <typename T> static T key_of(const pair_t & pair)
+{
+  T key;
+  std::memcpy(&key, &pair.key, sizeof(key));
+  return key;
+}
+
+template <typename T>
+static void sort(pair_t * _Nonnull pairs, ptrdiff_t count, bool is_descending)
+{
+  if (is_descending)
+    std::sort(
+        pairs, pairs + count, [](const pair_t & a, const pair_t & b)
+        { return key_of<T>(a) > key_of<T>(b); });
+  else
+    std::sort(
+        pairs, pairs + count, [](const pair_t & a, const pair_t & b)
+        { return key_of<T>(a) < key_of<T>(b); });
+}
+
+// kind: 0 float, 1 int, 2 uint keys
+extern "C" void std_sort(
+    pair_t * _Nonnull pairs, ptrdiff_t count, int32_t kind, bool is_descending)
+{
+  if (kind == 0)
+    sort<float>(pairs, count, is_descending);
+  else if (kind == 1)
+    sort<int32_t>(pairs, count, is_descending);
+  else
+    sort<uint32_t>(pairs, count, is_descending);
+}
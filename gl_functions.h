@@ -3,20 +3,26 @@
 #include <stdint.h>
 // clang-format off
 void (* glAttachShader)(uint32_t, uint32_t);
+void (* glBeginQuery)(uint32_t, uint32_t);
 void (* glBeginTransformFeedback)(uint32_t);
+void (* glBindBuffer)(uint32_t, uint32_t);
 void (* glBindFramebuffer)(uint32_t, uint32_t);
 void (* glBindProgramPipeline)(uint32_t);
 void (* glBindSamplers)(int32_t, int32_t, const uint32_t *);
 void (* glBindTextures)(int32_t, int32_t, const uint32_t *);
 void (* glBindTransformFeedback)(uint32_t, uint32_t);
+void (* glBlendFuncSeparate)(uint32_t, uint32_t, uint32_t, uint32_t);
 void (* glBlitNamedFramebuffer)(uint32_t, uint32_t, int32_t, int32_t, int32_t, int32_t, int32_t, int32_t, int32_t, int32_t, uint32_t, uint32_t);
 void (* glClear)(uint32_t);
 void (* glClearColor)(float, float, float, float);
+void (* glClearNamedFramebufferfv)(uint32_t, uint32_t, int32_t, const float *);
+uint32_t (* glClientWaitSync)(void *, uint32_t, uint64_t);
 void (* glCompileShader)(uint32_t);
 void (* glCreateBuffers)(int32_t, uint32_t *);
 void (* glCreateFramebuffers)(int32_t, uint32_t *);
 uint32_t (* glCreateProgram)();
 void (* glCreateProgramPipelines)(int32_t, uint32_t *);
+void (* glCreateQueries)(uint32_t, int32_t, uint32_t *);
 void (* glCreateSamplers)(int32_t, uint32_t *);
 uint32_t (* glCreateShader)(uint32_t);
 void (* glCreateTextures)(uint32_t, int32_t, uint32_t *);
@@ -26,26 +32,41 @@ void (* glDeleteBuffers)(int32_t, const uint32_t *);
 void (* glDeleteFramebuffers)(int32_t, const uint32_t *);
 void (* glDeleteProgram)(uint32_t);
 void (* glDeleteProgramPipelines)(int32_t, const uint32_t *);
+void (* glDeleteQueries)(int32_t, const uint32_t *);
 void (* glDeleteSamplers)(int32_t, const uint32_t *);
 void (* glDeleteShader)(uint32_t);
+void (* glDeleteSync)(void *);
 void (* glDeleteTextures)(int32_t, const uint32_t *);
 void (* glDeleteTransformFeedbacks)(int32_t, const uint32_t *);
 void (* glDetachShader)(uint32_t, uint32_t);
 void (* glDisable)(uint32_t);
 void (* glDrawArraysInstancedBaseInstance)(uint32_t, int32_t, int32_t, int32_t, int32_t);
 void (* glEnable)(uint32_t);
+void (* glEndQuery)(uint32_t);
 void (* glEndTransformFeedback)();
+void * (* glFenceSync)(uint32_t, uint32_t);
 void (* glFinish)();
+void (* glFlush)();
 void (* glGenerateTextureMipmap)(uint32_t);
 void (* glGenTextures)(int32_t, uint32_t *);
+void (* glGetIntegerv)(uint32_t, int32_t *);
+void (* glGetProgramBinary)(uint32_t, int32_t, int32_t *, uint32_t *, void *);
+void (* glGetProgramiv)(uint32_t, uint32_t, int32_t *);
+void (* glGetQueryObjectiv)(uint32_t, uint32_t, int32_t *);
+void (* glGetQueryObjectui64v)(uint32_t, uint32_t, uint64_t *);
+const char * (* glGetString)(uint32_t);
+const char * (* glGetStringi)(uint32_t, uint32_t);
+void (* glGetTextureLevelParameteriv)(uint32_t, int32_t, uint32_t, int32_t *);
 void (* glGetTextureSubImage)(uint32_t, int32_t, int32_t, int32_t, int32_t, int32_t, int32_t, int32_t, uint32_t, uint32_t, int32_t, void *);
 void (* glLinkProgram)(uint32_t);
 void * (* glMapNamedBufferRange)(uint32_t, ptrdiff_t, ptrdiff_t, uint32_t);
+void (* glMultiDrawArraysIndirect)(uint32_t, const void *, int32_t, int32_t);
 void (* glNamedBufferStorage)(uint32_t, ptrdiff_t, const void *, uint32_t);
 void (* glNamedFramebufferDrawBuffer)(uint32_t, int32_t);
 void (* glNamedFramebufferDrawBuffers)(uint32_t, int32_t, const int32_t *);
 void (* glNamedFramebufferReadBuffer)(uint32_t, int32_t);
 void (* glNamedFramebufferTextureLayer)(uint32_t, int32_t, uint32_t, int32_t, int32_t);
+void (* glProgramBinary)(uint32_t, uint32_t, const void *, int32_t);
 void (* glProgramParameteri)(uint32_t, uint32_t, int32_t);
 void (* glProgramUniform1dv)(uint32_t, int32_t, int32_t, const double *);
 void (* glProgramUniform1fv)(uint32_t, int32_t, int32_t, const float *);
@@ -54,10 +75,12 @@ void (* glProgramUniform1uiv)(uint32_t, int32_t, int32_t, const uint32_t *);
 void (* glProgramUniform2fv)(uint32_t, int32_t, int32_t, const float *);
 void (* glProgramUniform3fv)(uint32_t, int32_t, int32_t, const float *);
 void (* glProgramUniform4fv)(uint32_t, int32_t, int32_t, const float *);
+void (* glQueryCounter)(uint32_t, uint32_t);
 void (* glSamplerParameteri)(uint32_t, uint32_t, int32_t);
 void (* glScissor)(int32_t, int32_t, int32_t, int32_t);
 void (* glShaderSource)(uint32_t, int32_t, const char **, const int32_t *);
 void (* glTextureBufferRange)(uint32_t, uint32_t, uint32_t, ptrdiff_t, ptrdiff_t);
+void (* glTextureParameteriv)(uint32_t, uint32_t, const int32_t *);
 void (* glTextureStorage3D)(uint32_t, int32_t, uint32_t, int32_t, int32_t, int32_t);
 void (* glTextureStorage3DMultisample)(uint32_t, int32_t, uint32_t, int32_t, int32_t, int32_t, int32_t);
 void (* glTextureSubImage3D)(uint32_t, int32_t, int32_t, int32_t, int32_t, int32_t, int32_t, int32_t, uint32_t, uint32_t, const void *);
@@ -67,3 +90,98 @@ void (* glTransformFeedbackVaryings)(uint32_t, int32_t, const char **, uint32_t)
 void (* glUseProgramStages)(uint32_t, uint32_t, uint32_t);
 void (* glViewport)(int32_t, int32_t, int32_t, int32_t);
 // clang-format on
+
+// One row per pointer above, keep both lists in the same order. V rows
+// return void, R rows return ret. The last column is the number of bytes a
+// call uploads or reads back, counted by gl_trace.h.
+
+// clang-format off
+#define GL_FUNCTIONS(V, R) \
+  V(void, glAttachShader, (uint32_t p0, uint32_t p1), (p0, p1), 0) \
+  V(void, glBeginQuery, (uint32_t p0, uint32_t p1), (p0, p1), 0) \
+  V(void, glBeginTransformFeedback, (uint32_t p0), (p0), 0) \
+  V(void, glBindBuffer, (uint32_t p0, uint32_t p1), (p0, p1), 0) \
+  V(void, glBindFramebuffer, (uint32_t p0, uint32_t p1), (p0, p1), 0) \
+  V(void, glBindProgramPipeline, (uint32_t p0), (p0), 0) \
+  V(void, glBindSamplers, (int32_t p0, int32_t p1, const uint32_t * p2), (p0, p1, p2), 0) \
+  V(void, glBindTextures, (int32_t p0, int32_t p1, const uint32_t * p2), (p0, p1, p2), 0) \
+  V(void, glBindTransformFeedback, (uint32_t p0, uint32_t p1), (p0, p1), 0) \
+  V(void, glBlendFuncSeparate, (uint32_t p0, uint32_t p1, uint32_t p2, uint32_t p3), (p0, p1, p2, p3), 0) \
+  V(void, glBlitNamedFramebuffer, (uint32_t p0, uint32_t p1, int32_t p2, int32_t p3, int32_t p4, int32_t p5, int32_t p6, int32_t p7, int32_t p8, int32_t p9, uint32_t p10, uint32_t p11), (p0, p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11), 0) \
+  V(void, glClear, (uint32_t p0), (p0), 0) \
+  V(void, glClearColor, (float p0, float p1, float p2, float p3), (p0, p1, p2, p3), 0) \
+  V(void, glClearNamedFramebufferfv, (uint32_t p0, uint32_t p1, int32_t p2, const float * p3), (p0, p1, p2, p3), 0) \
+  R(uint32_t, glClientWaitSync, (void * p0, uint32_t p1, uint64_t p2), (p0, p1, p2), 0) \
+  V(void, glCompileShader, (uint32_t p0), (p0), 0) \
+  V(void, glCreateBuffers, (int32_t p0, uint32_t * p1), (p0, p1), 0) \
+  V(void, glCreateFramebuffers, (int32_t p0, uint32_t * p1), (p0, p1), 0) \
+  R(uint32_t, glCreateProgram, (), (), 0) \
+  V(void, glCreateProgramPipelines, (int32_t p0, uint32_t * p1), (p0, p1), 0) \
+  V(void, glCreateQueries, (uint32_t p0, int32_t p1, uint32_t * p2), (p0, p1, p2), 0) \
+  V(void, glCreateSamplers, (int32_t p0, uint32_t * p1), (p0, p1), 0) \
+  R(uint32_t, glCreateShader, (uint32_t p0), (p0), 0) \
+  V(void, glCreateTextures, (uint32_t p0, int32_t p1, uint32_t * p2), (p0, p1, p2), 0) \
+  V(void, glCreateTransformFeedbacks, (int32_t p0, uint32_t * p1), (p0, p1), 0) \
+  V(void, glDebugMessageCallback, (void * p0, void * p1), (p0, p1), 0) \
+  V(void, glDeleteBuffers, (int32_t p0, const uint32_t * p1), (p0, p1), 0) \
+  V(void, glDeleteFramebuffers, (int32_t p0, const uint32_t * p1), (p0, p1), 0) \
+  V(void, glDeleteProgram, (uint32_t p0), (p0), 0) \
+  V(void, glDeleteProgramPipelines, (int32_t p0, const uint32_t * p1), (p0, p1), 0) \
+  V(void, glDeleteQueries, (int32_t p0, const uint32_t * p1), (p0, p1), 0) \
+  V(void, glDeleteSamplers, (int32_t p0, const uint32_t * p1), (p0, p1), 0) \
+  V(void, glDeleteShader, (uint32_t p0), (p0), 0) \
+  V(void, glDeleteSync, (void * p0), (p0), 0) \
+  V(void, glDeleteTextures, (int32_t p0, const uint32_t * p1), (p0, p1), 0) \
+  V(void, glDeleteTransformFeedbacks, (int32_t p0, const uint32_t * p1), (p0, p1), 0) \
+  V(void, glDetachShader, (uint32_t p0, uint32_t p1), (p0, p1), 0) \
+  V(void, glDisable, (uint32_t p0), (p0), 0) \
+  V(void, glDrawArraysInstancedBaseInstance, (uint32_t p0, int32_t p1, int32_t p2, int32_t p3, int32_t p4), (p0, p1, p2, p3, p4), 0) \
+  V(void, glEnable, (uint32_t p0), (p0), 0) \
+  V(void, glEndQuery, (uint32_t p0), (p0), 0) \
+  V(void, glEndTransformFeedback, (), (), 0) \
+  R(void *, glFenceSync, (uint32_t p0, uint32_t p1), (p0, p1), 0) \
+  V(void, glFinish, (), (), 0) \
+  V(void, glFlush, (), (), 0) \
+  V(void, glGenerateTextureMipmap, (uint32_t p0), (p0), 0) \
+  V(void, glGenTextures, (int32_t p0, uint32_t * p1), (p0, p1), 0) \
+  V(void, glGetIntegerv, (uint32_t p0, int32_t * p1), (p0, p1), 0) \
+  V(void, glGetProgramBinary, (uint32_t p0, int32_t p1, int32_t * p2, uint32_t * p3, void * p4), (p0, p1, p2, p3, p4), p2 != NULL ? *p2 : 0) \
+  V(void, glGetProgramiv, (uint32_t p0, uint32_t p1, int32_t * p2), (p0, p1, p2), 0) \
+  V(void, glGetQueryObjectiv, (uint32_t p0, uint32_t p1, int32_t * p2), (p0, p1, p2), 0) \
+  V(void, glGetQueryObjectui64v, (uint32_t p0, uint32_t p1, uint64_t * p2), (p0, p1, p2), 0) \
+  R(const char *, glGetString, (uint32_t p0), (p0), 0) \
+  R(const char *, glGetStringi, (uint32_t p0, uint32_t p1), (p0, p1), 0) \
+  V(void, glGetTextureLevelParameteriv, (uint32_t p0, int32_t p1, uint32_t p2, int32_t * p3), (p0, p1, p2, p3), 0) \
+  V(void, glGetTextureSubImage, (uint32_t p0, int32_t p1, int32_t p2, int32_t p3, int32_t p4, int32_t p5, int32_t p6, int32_t p7, uint32_t p8, uint32_t p9, int32_t p10, void * p11), (p0, p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11), gpu_trace_pixel_bytes(p5, p6, p7, p8, p9)) \
+  V(void, glLinkProgram, (uint32_t p0), (p0), 0) \
+  R(void *, glMapNamedBufferRange, (uint32_t p0, ptrdiff_t p1, ptrdiff_t p2, uint32_t p3), (p0, p1, p2, p3), 0) \
+  V(void, glMultiDrawArraysIndirect, (uint32_t p0, const void * p1, int32_t p2, int32_t p3), (p0, p1, p2, p3), 0) \
+  V(void, glNamedBufferStorage, (uint32_t p0, ptrdiff_t p1, const void * p2, uint32_t p3), (p0, p1, p2, p3), p2 != NULL ? p1 : 0) \
+  V(void, glNamedFramebufferDrawBuffer, (uint32_t p0, int32_t p1), (p0, p1), 0) \
+  V(void, glNamedFramebufferDrawBuffers, (uint32_t p0, int32_t p1, const int32_t * p2), (p0, p1, p2), 0) \
+  V(void, glNamedFramebufferReadBuffer, (uint32_t p0, int32_t p1), (p0, p1), 0) \
+  V(void, glNamedFramebufferTextureLayer, (uint32_t p0, int32_t p1, uint32_t p2, int32_t p3, int32_t p4), (p0, p1, p2, p3, p4), 0) \
+  V(void, glProgramBinary, (uint32_t p0, uint32_t p1, const void * p2, int32_t p3), (p0, p1, p2, p3), p3) \
+  V(void, glProgramParameteri, (uint32_t p0, uint32_t p1, int32_t p2), (p0, p1, p2), 0) \
+  V(void, glProgramUniform1dv, (uint32_t p0, int32_t p1, int32_t p2, const double * p3), (p0, p1, p2, p3), p2 * 8) \
+  V(void, glProgramUniform1fv, (uint32_t p0, int32_t p1, int32_t p2, const float * p3), (p0, p1, p2, p3), p2 * 4) \
+  V(void, glProgramUniform1iv, (uint32_t p0, int32_t p1, int32_t p2, const int32_t * p3), (p0, p1, p2, p3), p2 * 4) \
+  V(void, glProgramUniform1uiv, (uint32_t p0, int32_t p1, int32_t p2, const uint32_t * p3), (p0, p1, p2, p3), p2 * 4) \
+  V(void, glProgramUniform2fv, (uint32_t p0, int32_t p1, int32_t p2, const float * p3), (p0, p1, p2, p3), p2 * 8) \
+  V(void, glProgramUniform3fv, (uint32_t p0, int32_t p1, int32_t p2, const float * p3), (p0, p1, p2, p3), p2 * 12) \
+  V(void, glProgramUniform4fv, (uint32_t p0, int32_t p1, int32_t p2, const float * p3), (p0, p1, p2, p3), p2 * 16) \
+  V(void, glQueryCounter, (uint32_t p0, uint32_t p1), (p0, p1), 0) \
+  V(void, glSamplerParameteri, (uint32_t p0, uint32_t p1, int32_t p2), (p0, p1, p2), 0) \
+  V(void, glScissor, (int32_t p0, int32_t p1, int32_t p2, int32_t p3), (p0, p1, p2, p3), 0) \
+  V(void, glShaderSource, (uint32_t p0, int32_t p1, const char ** p2, const int32_t * p3), (p0, p1, p2, p3), 0) \
+  V(void, glTextureBufferRange, (uint32_t p0, uint32_t p1, uint32_t p2, ptrdiff_t p3, ptrdiff_t p4), (p0, p1, p2, p3, p4), 0) \
+  V(void, glTextureParameteriv, (uint32_t p0, uint32_t p1, const int32_t * p2), (p0, p1, p2), 0) \
+  V(void, glTextureStorage3D, (uint32_t p0, int32_t p1, uint32_t p2, int32_t p3, int32_t p4, int32_t p5), (p0, p1, p2, p3, p4, p5), 0) \
+  V(void, glTextureStorage3DMultisample, (uint32_t p0, int32_t p1, uint32_t p2, int32_t p3, int32_t p4, int32_t p5, int32_t p6), (p0, p1, p2, p3, p4, p5, p6), 0) \
+  V(void, glTextureSubImage3D, (uint32_t p0, int32_t p1, int32_t p2, int32_t p3, int32_t p4, int32_t p5, int32_t p6, int32_t p7, uint32_t p8, uint32_t p9, const void * p10), (p0, p1, p2, p3, p4, p5, p6, p7, p8, p9, p10), gpu_trace_pixel_bytes(p5, p6, p7, p8, p9)) \
+  V(void, glTextureView, (uint32_t p0, uint32_t p1, uint32_t p2, uint32_t p3, int32_t p4, int32_t p5, int32_t p6, int32_t p7), (p0, p1, p2, p3, p4, p5, p6, p7), 0) \
+  V(void, glTransformFeedbackBufferRange, (uint32_t p0, int32_t p1, uint32_t p2, ptrdiff_t p3, ptrdiff_t p4), (p0, p1, p2, p3, p4), 0) \
+  V(void, glTransformFeedbackVaryings, (uint32_t p0, int32_t p1, const char ** p2, uint32_t p3), (p0, p1, p2, p3), 0) \
+  V(void, glUseProgramStages, (uint32_t p0, uint32_t p1, uint32_t p2), (p0, p1, p2), 0) \
+  V(void, glViewport, (int32_t p0, int32_t p1, int32_t p2, int32_t p3), (p0, p1, p2, p3), 0)
+// clang-format on
@@ -0,0 +1,734 @@
+#pragma once
+#include "SDL2/SDL.h"
+#include "gl_functions.h"
+#include "stdbool.h"
+
+// A GL implementation without a driver: gpu_load(gpu_mock_get_proc_address)
+// installs it in place of SDL_GL_GetProcAddress. Every call is counted and
+// logged, objects get names and buffers get CPU memory, so gpu_malloc
+// pointers can be written and read. Bound state is kept in gpu_mock for
+// tests to inspect. Nothing is drawn.
+
+#ifndef GPU_MOCK_OBJECTS
+#define GPU_MOCK_OBJECTS 16384
+#endif
+
+#ifndef GPU_MOCK_LOG
+#define GPU_MOCK_LOG 65536
+#endif
+
+#define GPU_MOCK_UNITS 32
+#define GPU_MOCK_CAPS 32
+
+#define GPU_MOCK_ENUM(ret, fn, params, args, bytes) gpu_mock_##fn##_t,
+
+enum gpu_mock_id_t
+{
+  GL_FUNCTIONS(GPU_MOCK_ENUM, GPU_MOCK_ENUM) gpu_mock_count_t
+};
+
+#define GPU_MOCK_NAME(ret, fn, params, args, bytes) #fn,
+
+static const char * _Nonnull gpu_mock_names[] = {
+    GL_FUNCTIONS(GPU_MOCK_NAME, GPU_MOCK_NAME)};
+
+// GL_ARB_multi_draw_indirect is last, is_mdi_hidden drops it.
+static const char * _Nonnull gpu_mock_extensions[] = {
+    "GL_KHR_debug",
+    "GL_ARB_multi_bind",
+    "GL_ARB_gpu_shader5",
+    "GL_ARB_texture_view",
+    "GL_ARB_base_instance",
+    "GL_ARB_buffer_storage",
+    "GL_ARB_texture_storage",
+    "GL_ARB_gpu_shader_fp64",
+    "GL_ARB_shader_precision",
+    "GL_ARB_conservative_depth",
+    "GL_ARB_get_program_binary",
+    "GL_ARB_transform_feedback2",
+    "GL_ARB_direct_state_access",
+    "GL_ARB_texture_buffer_range",
+    "GL_EXT_texture_mirror_clamp",
+    "GL_ARB_get_texture_sub_image",
+    "GL_ARB_texture_cube_map_array",
+    "GL_ARB_separate_shader_objects",
+    "GL_ARB_shading_language_420pack",
+    "GL_ARB_shading_language_packing",
+    "GL_EXT_texture_filter_anisotropic",
+    "GL_ARB_texture_buffer_object_rgb32",
+    "GL_ARB_multi_draw_indirect"};
+
+struct gpu_mock_names_t
+{
+  uint32_t next;
+  int32_t free_count;
+  uint32_t free[GPU_MOCK_OBJECTS];
+};
+
+static struct
+{
+  bool is_mdi_hidden;
+
+  uint64_t calls[gpu_mock_count_t];
+  int32_t log_count;
+  enum gpu_mock_id_t log[GPU_MOCK_LOG];
+
+  uint64_t draws;
+  uint64_t vertices;
+  uint64_t timestamp;
+  uintptr_t fences;
+
+  struct gpu_mock_names_t buffers;
+  struct gpu_mock_names_t textures;
+  struct gpu_mock_names_t fbos;
+  struct gpu_mock_names_t ppos;
+  struct gpu_mock_names_t smps;
+  struct gpu_mock_names_t xfbs;
+  struct gpu_mock_names_t queries;
+  struct gpu_mock_names_t programs;
+
+  uint8_t * _Nullable buffer[GPU_MOCK_OBJECTS];
+  ptrdiff_t buffer_bytes[GPU_MOCK_OBJECTS];
+  uint32_t tex_format[GPU_MOCK_OBJECTS];
+
+  uint32_t draw_fbo;
+  uint32_t read_fbo;
+  uint32_t ppo;
+  uint32_t xfb;
+  uint32_t pack_buffer;
+  uint32_t unpack_buffer;
+  uint32_t indirect_buffer;
+  uint32_t tex[GPU_MOCK_UNITS];
+  uint32_t smp[GPU_MOCK_UNITS];
+  uint32_t blend[4];
+  int32_t viewport[4];
+  int32_t scissor[4];
+  int32_t caps_count;
+  uint32_t caps[GPU_MOCK_CAPS];
+} gpu_mock = {};
+
+static inline void gpu_mock_record(enum gpu_mock_id_t id)
+{
+  gpu_mock.calls[id] += 1;
+
+  if (gpu_mock.log_count < GPU_MOCK_LOG)
+    gpu_mock.log[gpu_mock.log_count++] = id;
+}
+
+// Clears the call counts, the log and the draw counters, objects and bound
+// state are kept.
+static inline void gpu_mock_reset()
+{
+  SDL_memset(gpu_mock.calls, 0, sizeof(gpu_mock.calls));
+  gpu_mock.log_count = 0;
+  gpu_mock.draws = 0;
+  gpu_mock.vertices = 0;
+}
+
+static inline uint64_t gpu_mock_count(enum gpu_mock_id_t id)
+{
+  return gpu_mock.calls[id];
+}
+
+static inline int32_t
+gpu_mock_log(const enum gpu_mock_id_t * _Nullable * _Nonnull ids)
+{
+  *ids = gpu_mock.log;
+  return gpu_mock.log_count;
+}
+
+static inline bool gpu_mock_is_enabled(uint32_t cap)
+{
+  for (int32_t i = 0; i < gpu_mock.caps_count; ++i)
+    if (gpu_mock.caps[i] == cap)
+      return true;
+
+  return false;
+}
+
+static inline void gpu_mock_new(
+    struct gpu_mock_names_t * _Nonnull names, int32_t n,
+    uint32_t * _Nonnull ids)
+{
+  for (int32_t i = 0; i < n; ++i)
+  {
+    if (names->free_count > 0)
+      ids[i] = names->free[--names->free_count];
+    else if (names->next + 1 < GPU_MOCK_OBJECTS)
+      ids[i] = ++names->next;
+    else
+      ids[i] = 0;
+  }
+}
+
+static inline void gpu_mock_delete(
+    struct gpu_mock_names_t * _Nonnull names, int32_t n,
+    const uint32_t * _Nonnull ids)
+{
+  for (int32_t i = 0; i < n; ++i)
+    if (ids[i] != 0 && ids[i] < GPU_MOCK_OBJECTS &&
+        names->free_count < GPU_MOCK_OBJECTS)
+      names->free[names->free_count++] = ids[i];
+}
+
+#define GPU_MOCK_NOP_V(ret, fn, params, args, bytes)                           \
+  static void gpu_mock_nop_##fn params { gpu_mock_record(gpu_mock_##fn##_t); }
+
+#define GPU_MOCK_NOP_R(ret, fn, params, args, bytes)                           \
+  static ret gpu_mock_nop_##fn params                                          \
+  {                                                                            \
+    gpu_mock_record(gpu_mock_##fn##_t);                                        \
+    return (ret)0;                                                             \
+  }
+
+GL_FUNCTIONS(GPU_MOCK_NOP_V, GPU_MOCK_NOP_R)
+
+static void gpu_mock_glBindBuffer(uint32_t target, uint32_t id)
+{
+  gpu_mock_record(gpu_mock_glBindBuffer_t);
+
+  switch (target)
+  {
+  case (35051): // GL_PIXEL_PACK_BUFFER
+    gpu_mock.pack_buffer = id;
+    break;
+  case (35052): // GL_PIXEL_UNPACK_BUFFER
+    gpu_mock.unpack_buffer = id;
+    break;
+  case (36671): // GL_DRAW_INDIRECT_BUFFER
+    gpu_mock.indirect_buffer = id;
+    break;
+  default:
+    break;
+  }
+}
+
+static void gpu_mock_glBindFramebuffer(uint32_t target, uint32_t id)
+{
+  gpu_mock_record(gpu_mock_glBindFramebuffer_t);
+
+  if (target != 36009) // GL_DRAW_FRAMEBUFFER
+    gpu_mock.read_fbo = id;
+  if (target != 36008) // GL_READ_FRAMEBUFFER
+    gpu_mock.draw_fbo = id;
+}
+
+static void gpu_mock_glBindProgramPipeline(uint32_t id)
+{
+  gpu_mock_record(gpu_mock_glBindProgramPipeline_t);
+  gpu_mock.ppo = id;
+}
+
+static void gpu_mock_glBindSamplers(
+    int32_t first, int32_t count, const uint32_t * _Nullable ids)
+{
+  gpu_mock_record(gpu_mock_glBindSamplers_t);
+
+  for (int32_t i = 0; i < count && first + i < GPU_MOCK_UNITS; ++i)
+    gpu_mock.smp[first + i] = ids ? ids[i] : 0;
+}
+
+static void gpu_mock_glBindTextures(
+    int32_t first, int32_t count, const uint32_t * _Nullable ids)
+{
+  gpu_mock_record(gpu_mock_glBindTextures_t);
+
+  for (int32_t i = 0; i < count && first + i < GPU_MOCK_UNITS; ++i)
+    gpu_mock.tex[first + i] = ids ? ids[i] : 0;
+}
+
+static void gpu_mock_glBindTransformFeedback(uint32_t target, uint32_t id)
+{
+  gpu_mock_record(gpu_mock_glBindTransformFeedback_t);
+  gpu_mock.xfb = id;
+}
+
+static void gpu_mock_glBlendFuncSeparate(
+    uint32_t src_rgb, uint32_t dst_rgb, uint32_t src_alpha, uint32_t dst_alpha)
+{
+  gpu_mock_record(gpu_mock_glBlendFuncSeparate_t);
+  gpu_mock.blend[0] = src_rgb;
+  gpu_mock.blend[1] = dst_rgb;
+  gpu_mock.blend[2] = src_alpha;
+  gpu_mock.blend[3] = dst_alpha;
+}
+
+static uint32_t
+gpu_mock_glClientWaitSync(void * _Nullable fence, uint32_t flags, uint64_t ns)
+{
+  gpu_mock_record(gpu_mock_glClientWaitSync_t);
+  return 37146; // GL_ALREADY_SIGNALED
+}
+
+static void gpu_mock_glCreateBuffers(int32_t n, uint32_t * _Nonnull ids)
+{
+  gpu_mock_record(gpu_mock_glCreateBuffers_t);
+  gpu_mock_new(&gpu_mock.buffers, n, ids);
+}
+
+static void gpu_mock_glCreateFramebuffers(int32_t n, uint32_t * _Nonnull ids)
+{
+  gpu_mock_record(gpu_mock_glCreateFramebuffers_t);
+  gpu_mock_new(&gpu_mock.fbos, n, ids);
+}
+
+static uint32_t gpu_mock_glCreateProgram()
+{
+  gpu_mock_record(gpu_mock_glCreateProgram_t);
+  uint32_t id = 0;
+  gpu_mock_new(&gpu_mock.programs, 1, &id);
+  return id;
+}
+
+static void
+gpu_mock_glCreateProgramPipelines(int32_t n, uint32_t * _Nonnull ids)
+{
+  gpu_mock_record(gpu_mock_glCreateProgramPipelines_t);
+  gpu_mock_new(&gpu_mock.ppos, n, ids);
+}
+
+static void
+gpu_mock_glCreateQueries(uint32_t target, int32_t n, uint32_t * _Nonnull ids)
+{
+  gpu_mock_record(gpu_mock_glCreateQueries_t);
+  gpu_mock_new(&gpu_mock.queries, n, ids);
+}
+
+static void gpu_mock_glCreateSamplers(int32_t n, uint32_t * _Nonnull ids)
+{
+  gpu_mock_record(gpu_mock_glCreateSamplers_t);
+  gpu_mock_new(&gpu_mock.smps, n, ids);
+}
+
+static uint32_t gpu_mock_glCreateShader(uint32_t type)
+{
+  gpu_mock_record(gpu_mock_glCreateShader_t);
+  uint32_t id = 0;
+  gpu_mock_new(&gpu_mock.programs, 1, &id);
+  return id;
+}
+
+static void
+gpu_mock_glCreateTextures(uint32_t target, int32_t n, uint32_t * _Nonnull ids)
+{
+  gpu_mock_record(gpu_mock_glCreateTextures_t);
+  gpu_mock_new(&gpu_mock.textures, n, ids);
+}
+
+static void
+gpu_mock_glCreateTransformFeedbacks(int32_t n, uint32_t * _Nonnull ids)
+{
+  gpu_mock_record(gpu_mock_glCreateTransformFeedbacks_t);
+  gpu_mock_new(&gpu_mock.xfbs, n, ids);
+}
+
+static void
+gpu_mock_glDeleteBuffers(int32_t n, const uint32_t * _Nonnull ids)
+{
+  gpu_mock_record(gpu_mock_glDeleteBuffers_t);
+
+  for (int32_t i = 0; i < n; ++i)
+  {
+    if (ids[i] == 0 || ids[i] >= GPU_MOCK_OBJECTS)
+      continue;
+
+    SDL_free(gpu_mock.buffer[ids[i]]);
+    gpu_mock.buffer[ids[i]] = NULL;
+    gpu_mock.buffer_bytes[ids[i]] = 0;
+  }
+
+  gpu_mock_delete(&gpu_mock.buffers, n, ids);
+}
+
+static void
+gpu_mock_glDeleteFramebuffers(int32_t n, const uint32_t * _Nonnull ids)
+{
+  gpu_mock_record(gpu_mock_glDeleteFramebuffers_t);
+  gpu_mock_delete(&gpu_mock.fbos, n, ids);
+}
+
+static void gpu_mock_glDeleteProgram(uint32_t id)
+{
+  gpu_mock_record(gpu_mock_glDeleteProgram_t);
+  gpu_mock_delete(&gpu_mock.programs, 1, &id);
+}
+
+static void
+gpu_mock_glDeleteProgramPipelines(int32_t n, const uint32_t * _Nonnull ids)
+{
+  gpu_mock_record(gpu_mock_glDeleteProgramPipelines_t);
+  gpu_mock_delete(&gpu_mock.ppos, n, ids);
+}
+
+static void
+gpu_mock_glDeleteSamplers(int32_t n, const uint32_t * _Nonnull ids)
+{
+  gpu_mock_record(gpu_mock_glDeleteSamplers_t);
+  gpu_mock_delete(&gpu_mock.smps, n, ids);
+}
+
+static void gpu_mock_glDeleteShader(uint32_t id)
+{
+  gpu_mock_record(gpu_mock_glDeleteShader_t);
+  gpu_mock_delete(&gpu_mock.programs, 1, &id);
+}
+
+static void
+gpu_mock_glDeleteTextures(int32_t n, const uint32_t * _Nonnull ids)
+{
+  gpu_mock_record(gpu_mock_glDeleteTextures_t);
+
+  for (int32_t i = 0; i < n; ++i)
+    if (ids[i] < GPU_MOCK_OBJECTS)
+      gpu_mock.tex_format[ids[i]] = 0;
+
+  gpu_mock_delete(&gpu_mock.textures, n, ids);
+}
+
+static void
+gpu_mock_glDeleteTransformFeedbacks(int32_t n, const uint32_t * _Nonnull ids)
+{
+  gpu_mock_record(gpu_mock_glDeleteTransformFeedbacks_t);
+  gpu_mock_delete(&gpu_mock.xfbs, n, ids);
+}
+
+static void gpu_mock_glDisable(uint32_t cap)
+{
+  gpu_mock_record(gpu_mock_glDisable_t);
+
+  for (int32_t i = 0; i < gpu_mock.caps_count; ++i)
+  {
+    if (gpu_mock.caps[i] == cap)
+    {
+      gpu_mock.caps[i] = gpu_mock.caps[--gpu_mock.caps_count];
+      break;
+    }
+  }
+}
+
+static void gpu_mock_glDrawArraysInstancedBaseInstance(
+    uint32_t mode, int32_t first, int32_t count, int32_t instance_count,
+    int32_t instance_first)
+{
+  gpu_mock_record(gpu_mock_glDrawArraysInstancedBaseInstance_t);
+  gpu_mock.draws += 1;
+  gpu_mock.vertices += (uint64_t)count * (uint64_t)instance_count;
+}
+
+static void gpu_mock_glEnable(uint32_t cap)
+{
+  gpu_mock_record(gpu_mock_glEnable_t);
+
+  if (!gpu_mock_is_enabled(cap) && gpu_mock.caps_count < GPU_MOCK_CAPS)
+    gpu_mock.caps[gpu_mock.caps_count++] = cap;
+}
+
+static void * _Nullable gpu_mock_glFenceSync(uint32_t condition, uint32_t flags)
+{
+  gpu_mock_record(gpu_mock_glFenceSync_t);
+  gpu_mock.fences += 1;
+  return (void *)gpu_mock.fences;
+}
+
+static void gpu_mock_glGenTextures(int32_t n, uint32_t * _Nonnull ids)
+{
+  gpu_mock_record(gpu_mock_glGenTextures_t);
+  gpu_mock_new(&gpu_mock.textures, n, ids);
+}
+
+static void gpu_mock_glGetIntegerv(uint32_t pname, int32_t * _Nonnull value)
+{
+  gpu_mock_record(gpu_mock_glGetIntegerv_t);
+
+  int32_t extension_count =
+      (int32_t)(sizeof(gpu_mock_extensions) / sizeof(gpu_mock_extensions[0]));
+
+  switch (pname)
+  {
+  case (33309): // GL_NUM_EXTENSIONS
+    *value = gpu_mock.is_mdi_hidden ? extension_count - 1 : extension_count;
+    break;
+  case (36006): // GL_DRAW_FRAMEBUFFER_BINDING
+    *value = (int32_t)gpu_mock.draw_fbo;
+    break;
+  case (36010): // GL_READ_FRAMEBUFFER_BINDING
+    *value = (int32_t)gpu_mock.read_fbo;
+    break;
+  default:
+    *value = 0;
+  }
+}
+
+static void gpu_mock_glGetProgramiv(
+    uint32_t id, uint32_t pname, int32_t * _Nonnull value)
+{
+  gpu_mock_record(gpu_mock_glGetProgramiv_t);
+  *value = pname == 35714 ? 1 : 0; // GL_LINK_STATUS
+}
+
+static void gpu_mock_glGetQueryObjectiv(
+    uint32_t id, uint32_t pname, int32_t * _Nonnull value)
+{
+  gpu_mock_record(gpu_mock_glGetQueryObjectiv_t);
+  *value = 1;
+}
+
+static void gpu_mock_glGetQueryObjectui64v(
+    uint32_t id, uint32_t pname, uint64_t * _Nonnull value)
+{
+  gpu_mock_record(gpu_mock_glGetQueryObjectui64v_t);
+  gpu_mock.timestamp += 1000;
+  *value = gpu_mock.timestamp;
+}
+
+static const char * _Nullable gpu_mock_glGetString(uint32_t name)
+{
+  gpu_mock_record(gpu_mock_glGetString_t);
+
+  switch (name)
+  {
+  case (7936): // GL_VENDOR
+    return "gpulib";
+  case (7937): // GL_RENDERER
+    return "gl_mock.h";
+  case (7938): // GL_VERSION
+    return "4.5";
+  default:
+    return "";
+  }
+}
+
+static const char * _Nullable
+gpu_mock_glGetStringi(uint32_t name, uint32_t index)
+{
+  gpu_mock_record(gpu_mock_glGetStringi_t);
+
+  if (index >= sizeof(gpu_mock_extensions) / sizeof(gpu_mock_extensions[0]))
+    return NULL;
+
+  return gpu_mock_extensions[index];
+}
+
+static void gpu_mock_glGetTextureLevelParameteriv(
+    uint32_t id, int32_t level, uint32_t pname, int32_t * _Nonnull value)
+{
+  gpu_mock_record(gpu_mock_glGetTextureLevelParameteriv_t);
+  *value = 0;
+
+  if (pname == 4099 && id < GPU_MOCK_OBJECTS) // GL_TEXTURE_INTERNAL_FORMAT
+    *value = (int32_t)gpu_mock.tex_format[id];
+}
+
+static void gpu_mock_glGetTextureSubImage(
+    uint32_t id, int32_t level, int32_t x, int32_t y, int32_t z, int32_t width,
+    int32_t height, int32_t depth, uint32_t pixel_format, uint32_t pixel_type,
+    int32_t bytes, void * _Nullable pixels)
+{
+  gpu_mock_record(gpu_mock_glGetTextureSubImage_t);
+
+  // With a pack buffer bound pixels is an offset, the buffer keeps its bytes
+  if (gpu_mock.pack_buffer == 0 && pixels != NULL && bytes > 0)
+    SDL_memset(pixels, 0, (size_t)bytes);
+}
+
+static void * _Nullable gpu_mock_glMapNamedBufferRange(
+    uint32_t id, ptrdiff_t offset, ptrdiff_t bytes, uint32_t flags)
+{
+  gpu_mock_record(gpu_mock_glMapNamedBufferRange_t);
+
+  if (id == 0 || id >= GPU_MOCK_OBJECTS || gpu_mock.buffer[id] == NULL ||
+      offset + bytes > gpu_mock.buffer_bytes[id])
+    return NULL;
+
+  return gpu_mock.buffer[id] + offset;
+}
+
+static void gpu_mock_glMultiDrawArraysIndirect(
+    uint32_t mode, const void * _Nullable indirect, int32_t draw_count,
+    int32_t stride)
+{
+  gpu_mock_record(gpu_mock_glMultiDrawArraysIndirect_t);
+  gpu_mock.draws += (uint64_t)draw_count;
+
+  uint32_t id = gpu_mock.indirect_buffer;
+
+  if (id == 0 || id >= GPU_MOCK_OBJECTS || gpu_mock.buffer[id] == NULL)
+    return;
+
+  ptrdiff_t offset = (ptrdiff_t)indirect;
+  stride = stride ? stride : 16;
+
+  for (int32_t i = 0; i < draw_count; ++i)
+  {
+    if (offset + stride * (i + 1) > gpu_mock.buffer_bytes[id])
+      break;
+
+    const uint32_t * cmd =
+        (const uint32_t *)(gpu_mock.buffer[id] + offset + stride * i);
+    gpu_mock.vertices += (uint64_t)cmd[0] * (uint64_t)cmd[1];
+  }
+}
+
+static void gpu_mock_glNamedBufferStorage(
+    uint32_t id, ptrdiff_t bytes, const void * _Nullable data, uint32_t flags)
+{
+  gpu_mock_record(gpu_mock_glNamedBufferStorage_t);
+
+  if (id == 0 || id >= GPU_MOCK_OBJECTS || gpu_mock.buffer[id] != NULL)
+    return;
+
+  gpu_mock.buffer[id] = SDL_calloc(1, (size_t)bytes);
+  gpu_mock.buffer_bytes[id] = gpu_mock.buffer[id] ? bytes : 0;
+
+  if (gpu_mock.buffer[id] && data)
+    SDL_memcpy(gpu_mock.buffer[id], data, (size_t)bytes);
+}
+
+static void
+gpu_mock_glScissor(int32_t x, int32_t y, int32_t width, int32_t height)
+{
+  gpu_mock_record(gpu_mock_glScissor_t);
+  gpu_mock.scissor[0] = x;
+  gpu_mock.scissor[1] = y;
+  gpu_mock.scissor[2] = width;
+  gpu_mock.scissor[3] = height;
+}
+
+static void gpu_mock_glTextureBufferRange(
+    uint32_t id, uint32_t format, uint32_t buffer_id, ptrdiff_t offset,
+    ptrdiff_t bytes)
+{
+  gpu_mock_record(gpu_mock_glTextureBufferRange_t);
+
+  if (id < GPU_MOCK_OBJECTS)
+    gpu_mock.tex_format[id] = format;
+}
+
+static void gpu_mock_glTextureStorage3D(
+    uint32_t id, int32_t levels, uint32_t format, int32_t width,
+    int32_t height, int32_t depth)
+{
+  gpu_mock_record(gpu_mock_glTextureStorage3D_t);
+
+  if (id < GPU_MOCK_OBJECTS)
+    gpu_mock.tex_format[id] = format;
+}
+
+static void gpu_mock_glTextureStorage3DMultisample(
+    uint32_t id, int32_t samples, uint32_t format, int32_t width,
+    int32_t height, int32_t depth, int32_t is_fixed)
+{
+  gpu_mock_record(gpu_mock_glTextureStorage3DMultisample_t);
+
+  if (id < GPU_MOCK_OBJECTS)
+    gpu_mock.tex_format[id] = format;
+}
+
+static void gpu_mock_glTextureView(
+    uint32_t id, uint32_t target, uint32_t source_id, uint32_t format,
+    int32_t level_first, int32_t level_count, int32_t layer_first,
+    int32_t layer_count)
+{
+  gpu_mock_record(gpu_mock_glTextureView_t);
+
+  if (id < GPU_MOCK_OBJECTS)
+    gpu_mock.tex_format[id] = format;
+}
+
+static void
+gpu_mock_glViewport(int32_t x, int32_t y, int32_t width, int32_t height)
+{
+  gpu_mock_record(gpu_mock_glViewport_t);
+  gpu_mock.viewport[0] = x;
+  gpu_mock.viewport[1] = y;
+  gpu_mock.viewport[2] = width;
+  gpu_mock.viewport[3] = height;
+}
+
+// Loaded by gpu_load outside of gl_functions.h, not recorded
+static void gpu_mock_glCreateVertexArrays(int32_t n, uint32_t * _Nonnull ids)
+{
+  for (int32_t i = 0; i < n; ++i)
+    ids[i] = (uint32_t)i + 1;
+}
+
+static void gpu_mock_glBindVertexArray(uint32_t id) {}
+
+static void gpu_mock_glBlendFunc(uint32_t src, uint32_t dst)
+{
+  gpu_mock.blend[0] = gpu_mock.blend[2] = src;
+  gpu_mock.blend[1] = gpu_mock.blend[3] = dst;
+}
+
+#define GPU_MOCK_PROC(fn) {#fn, (void *)gpu_mock_##fn}
+#define GPU_MOCK_NOP(ret, fn, params, args, bytes) {#fn, (void *)gpu_mock_nop_##fn},
+
+static inline void * _Nullable
+gpu_mock_get_proc_address(const char * _Nonnull name)
+{
+  static const struct
+  {
+    const char * _Nonnull name;
+    void * _Nonnull proc;
+  } procs[] = {
+      // clang-format off
+      GPU_MOCK_PROC(glBindBuffer),
+      GPU_MOCK_PROC(glBindFramebuffer),
+      GPU_MOCK_PROC(glBindProgramPipeline),
+      GPU_MOCK_PROC(glBindSamplers),
+      GPU_MOCK_PROC(glBindTextures),
+      GPU_MOCK_PROC(glBindTransformFeedback),
+      GPU_MOCK_PROC(glBindVertexArray),
+      GPU_MOCK_PROC(glBlendFunc),
+      GPU_MOCK_PROC(glBlendFuncSeparate),
+      GPU_MOCK_PROC(glClientWaitSync),
+      GPU_MOCK_PROC(glCreateBuffers),
+      GPU_MOCK_PROC(glCreateFramebuffers),
+      GPU_MOCK_PROC(glCreateProgram),
+      GPU_MOCK_PROC(glCreateProgramPipelines),
+      GPU_MOCK_PROC(glCreateQueries),
+      GPU_MOCK_PROC(glCreateSamplers),
+      GPU_MOCK_PROC(glCreateShader),
+      GPU_MOCK_PROC(glCreateTextures),
+      GPU_MOCK_PROC(glCreateTransformFeedbacks),
+      GPU_MOCK_PROC(glCreateVertexArrays),
+      GPU_MOCK_PROC(glDeleteBuffers),
+      GPU_MOCK_PROC(glDeleteFramebuffers),
+      GPU_MOCK_PROC(glDeleteProgram),
+      GPU_MOCK_PROC(glDeleteProgramPipelines),
+      GPU_MOCK_PROC(glDeleteSamplers),
+      GPU_MOCK_PROC(glDeleteShader),
+      GPU_MOCK_PROC(glDeleteTextures),
+      GPU_MOCK_PROC(glDeleteTransformFeedbacks),
+      GPU_MOCK_PROC(glDisable),
+      GPU_MOCK_PROC(glDrawArraysInstancedBaseInstance),
+      GPU_MOCK_PROC(glEnable),
+      GPU_MOCK_PROC(glFenceSync),
+      GPU_MOCK_PROC(glGenTextures),
+      GPU_MOCK_PROC(glGetIntegerv),
+      GPU_MOCK_PROC(glGetProgramiv),
+      GPU_MOCK_PROC(glGetQueryObjectiv),
+      GPU_MOCK_PROC(glGetQueryObjectui64v),
+      GPU_MOCK_PROC(glGetString),
+      GPU_MOCK_PROC(glGetStringi),
+      GPU_MOCK_PROC(glGetTextureLevelParameteriv),
+      GPU_MOCK_PROC(glGetTextureSubImage),
+      GPU_MOCK_PROC(glMapNamedBufferRange),
+      GPU_MOCK_PROC(glMultiDrawArraysIndirect),
+      GPU_MOCK_PROC(glNamedBufferStorage),
+      GPU_MOCK_PROC(glScissor),
+      GPU_MOCK_PROC(glTextureBufferRange),
+      GPU_MOCK_PROC(glTextureStorage3D),
+      GPU_MOCK_PROC(glTextureStorage3DMultisample),
+      GPU_MOCK_PROC(glTextureView),
+      GPU_MOCK_PROC(glViewport),
+      GL_FUNCTIONS(GPU_MOCK_NOP, GPU_MOCK_NOP)
+      // clang-format on
+  };
+
+  for (size_t i = 0; i < sizeof(procs) / sizeof(procs[0]); ++i)
+    if (SDL_strcmp(procs[i].name, name) == 0)
+      return procs[i].proc;
+
+  return NULL;
+}
@@ -0,0 +1,194 @@
+#pragma once
+#include "SDL2/SDL.h"
+#include "gl_functions.h"
+#include "stdbool.h"
+
+struct gpu_trace_t
+{
+  const char * _Nullable name;
+  uint64_t calls;
+  uint64_t ticks;
+  uint64_t bytes;
+};
+
+#define GPU_TRACE_ENUM(ret, fn, params, args, bytes) gpu_trace_##fn##_t,
+
+enum gpu_trace_id_t
+{
+  GL_FUNCTIONS(GPU_TRACE_ENUM, GPU_TRACE_ENUM) gpu_trace_count_t
+};
+
+static struct
+{
+  struct gpu_trace_t frame[gpu_trace_count_t];
+  struct gpu_trace_t last[gpu_trace_count_t];
+  struct gpu_trace_t total[gpu_trace_count_t];
+  uint64_t frames;
+} gpu_trace = {};
+
+static inline uint64_t gpu_trace_pixel_bytes(
+    int32_t width, int32_t height, int32_t depth, uint32_t pixel_format,
+    uint32_t pixel_type)
+{
+  uint64_t size = 4;
+
+  switch (pixel_type)
+  {
+  case (0x1400): // GL_BYTE
+  case (0x1401): // GL_UNSIGNED_BYTE
+    size = 1;
+    break;
+  case (0x1402): // GL_SHORT
+  case (0x1403): // GL_UNSIGNED_SHORT
+  case (0x140B): // GL_HALF_FLOAT
+    size = 2;
+    break;
+  default:
+    break;
+  }
+
+  // Packed types hold every component in one 32-bit word
+  if (pixel_type != 0x8C3B && pixel_type != 0x8368 && pixel_type != 0x84FA)
+  {
+    switch (pixel_format)
+    {
+    case (0x8227): // GL_RG
+    case (0x8228): // GL_RG_INTEGER
+      size *= 2;
+      break;
+    case (0x1907): // GL_RGB
+    case (0x80E0): // GL_BGR
+    case (0x8D98): // GL_RGB_INTEGER
+      size *= 3;
+      break;
+    case (0x1908): // GL_RGBA
+    case (0x80E1): // GL_BGRA
+    case (0x8D99): // GL_RGBA_INTEGER
+      size *= 4;
+      break;
+    default:
+      break;
+    }
+  }
+
+  return size * (uint64_t)width * (uint64_t)height * (uint64_t)depth;
+}
+
+static inline void
+gpu_trace_add(enum gpu_trace_id_t id, uint64_t ticks, uint64_t bytes)
+{
+  gpu_trace.frame[id].calls += 1;
+  gpu_trace.frame[id].ticks += SDL_GetPerformanceCounter() - ticks;
+  gpu_trace.frame[id].bytes += bytes;
+}
+
+#define GPU_TRACE_WRAP_V(ret, fn, params, args, bytes)                         \
+  static void (*_Nullable gpu_trace_real_##fn) params = NULL;                  \
+  static void gpu_trace_##fn params                                            \
+  {                                                                            \
+    uint64_t ticks = SDL_GetPerformanceCounter();                              \
+    gpu_trace_real_##fn args;                                                  \
+    gpu_trace_add(gpu_trace_##fn##_t, ticks, (uint64_t)(bytes));               \
+  }
+
+#define GPU_TRACE_WRAP_R(ret, fn, params, args, bytes)                         \
+  static ret (*_Nullable gpu_trace_real_##fn) params = NULL;                   \
+  static ret gpu_trace_##fn params                                             \
+  {                                                                            \
+    uint64_t ticks = SDL_GetPerformanceCounter();                              \
+    ret result = gpu_trace_real_##fn args;                                     \
+    gpu_trace_add(gpu_trace_##fn##_t, ticks, (uint64_t)(bytes));               \
+    return result;                                                             \
+  }
+
+GL_FUNCTIONS(GPU_TRACE_WRAP_V, GPU_TRACE_WRAP_R)
+
+#define GPU_TRACE_INSTALL(ret, fn, params, args, bytes)                        \
+  gpu_trace.frame[gpu_trace_##fn##_t].name = #fn;                              \
+  gpu_trace.last[gpu_trace_##fn##_t].name = #fn;                               \
+  gpu_trace.total[gpu_trace_##fn##_t].name = #fn;                              \
+  if (fn != NULL && fn != gpu_trace_##fn)                                      \
+  {                                                                            \
+    gpu_trace_real_##fn = fn;                                                  \
+    fn = gpu_trace_##fn;                                                       \
+  }
+
+// Called by gpu_load once the pointers are loaded.
+static inline void gpu_trace_install()
+{
+  GL_FUNCTIONS(GPU_TRACE_INSTALL, GPU_TRACE_INSTALL)
+}
+
+static inline void gpu_trace_reset()
+{
+  for (int32_t i = 0; i < gpu_trace_count_t; ++i)
+  {
+    gpu_trace.frame[i].calls = gpu_trace.frame[i].ticks = 0;
+    gpu_trace.frame[i].bytes = 0;
+    gpu_trace.last[i] = gpu_trace.total[i] = gpu_trace.frame[i];
+  }
+  gpu_trace.frames = 0;
+}
+
+// Called by gpu_swap, moves the counters of the current frame to the last
+// frame and the totals.
+static inline void gpu_trace_frame()
+{
+  for (int32_t i = 0; i < gpu_trace_count_t; ++i)
+  {
+    gpu_trace.last[i] = gpu_trace.frame[i];
+    gpu_trace.total[i].calls += gpu_trace.frame[i].calls;
+    gpu_trace.total[i].ticks += gpu_trace.frame[i].ticks;
+    gpu_trace.total[i].bytes += gpu_trace.frame[i].bytes;
+    gpu_trace.frame[i].calls = 0;
+    gpu_trace.frame[i].ticks = 0;
+    gpu_trace.frame[i].bytes = 0;
+  }
+  gpu_trace.frames += 1;
+}
+
+// Rows are indexed by enum gpu_trace_id_t, ticks are in
+// SDL_GetPerformanceFrequency units.
+static inline int32_t gpu_trace_results(
+    bool is_total, const struct gpu_trace_t * _Nullable * _Nonnull rows)
+{
+  *rows = is_total ? gpu_trace.total : gpu_trace.last;
+  return gpu_trace_count_t;
+}
+
+static inline void gpu_trace_dump(bool is_total)
+{
+  const struct gpu_trace_t * rows = NULL;
+  int32_t rows_count = gpu_trace_results(is_total, &rows);
+
+  int32_t order[gpu_trace_count_t];
+  int32_t order_count = 0;
+
+  for (int32_t i = 0; i < rows_count; ++i)
+  {
+    if (rows[i].calls == 0)
+      continue;
+
+    int32_t j = order_count;
+    for (; j > 0 && rows[order[j - 1]].ticks < rows[i].ticks; --j)
+      order[j] = order[j - 1];
+    order[j] = i;
+    order_count += 1;
+  }
+
+  double us = 1000000.0 / (double)SDL_GetPerformanceFrequency();
+
+  SDL_Log(
+      "%-34s %10s %12s %10s %14s", is_total ? "GL calls (total)" : "GL calls",
+      "calls", "cpu us", "us/call", "bytes");
+
+  for (int32_t i = 0; i < order_count; ++i)
+  {
+    const struct gpu_trace_t * row = &rows[order[i]];
+    SDL_Log(
+        "%-34s %10llu %12.1f %10.3f %14llu", row->name,
+        (unsigned long long)row->calls, (double)row->ticks * us,
+        (double)row->ticks * us / (double)row->calls,
+        (unsigned long long)row->bytes);
+  }
+}
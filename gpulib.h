@@ -3,6 +3,10 @@
 #include "gl_functions.h"
 #include "stdbool.h"
 
+#ifdef GPU_TRACE
+#include "gl_trace.h"
+#endif
+
 struct gpu_cmd_t
 {
   int32_t count;
@@ -38,7 +42,8 @@ enum gpu_draw_t
 enum gpu_shader_t
 {
   gpu_frag_t = 0x8B30, // GL_FRAGMENT_SHADER
-  gpu_vert_t = 0x8B31  // GL_VERTEX_SHADER
+  gpu_vert_t = 0x8B31, // GL_VERTEX_SHADER
+  gpu_geom_t = 0x8DD9  // GL_GEOMETRY_SHADER
 };
 
 enum gpu_global_t
@@ -85,12 +90,27 @@ enum gpu_tex_mem_format_t
 
 enum gpu_tex_format_t
 {
-  gpu_d_f32_t = 0x8CAC,    // GL_DEPTH_COMPONENT32F
-  gpu_rgb_b8_t = 0x8051,   // GL_RGB8
-  gpu_rgba_b8_t = 0x8058,  // GL_RGBA8
-  gpu_srgb_b8_t = 0x8C41,  // GL_SRGB8
-  gpu_srgba_b8_t = 0x8C43, // GL_SRGB8_ALPHA8
-  gpu_rgba_f32_t = 0x8814  // GL_RGBA32F
+  gpu_d_b16_t = 0x81A5,            // GL_DEPTH_COMPONENT16
+  gpu_d_f32_t = 0x8CAC,            // GL_DEPTH_COMPONENT32F
+  gpu_ds_b24_u8_t = 0x88F0,        // GL_DEPTH24_STENCIL8
+  gpu_r_b8_t = 0x8229,             // GL_R8
+  gpu_r_f16_t = 0x822D,            // GL_R16F
+  gpu_r_f32_t = 0x822E,            // GL_R32F
+  gpu_r_i32_t = 0x8235,            // GL_R32I
+  gpu_r_u32_t = 0x8236,            // GL_R32UI
+  gpu_rg_f16_t = 0x822F,           // GL_RG16F
+  gpu_rg_f32_t = 0x8230,           // GL_RG32F
+  gpu_rg_i32_t = 0x823B,           // GL_RG32I
+  gpu_rg_u32_t = 0x823C,           // GL_RG32UI
+  gpu_rgb_b8_t = 0x8051,           // GL_RGB8
+  gpu_rgb_f11f11f10_t = 0x8C3A,    // GL_R11F_G11F_B10F
+  gpu_rgba_b8_t = 0x8058,          // GL_RGBA8
+  gpu_rgba_b10b10b10b2_t = 0x8059, // GL_RGB10_A2
+  gpu_srgb_b8_t = 0x8C41,          // GL_SRGB8
+  gpu_srgba_b8_t = 0x8C43,         // GL_SRGB8_ALPHA8
+  gpu_rgba_f32_t = 0x8814,         // GL_RGBA32F
+  gpu_rgba_i32_t = 0x8D82,         // GL_RGBA32I
+  gpu_rgba_u32_t = 0x8D70          // GL_RGBA32UI
 };
 
 enum gpu_smp_filter_t
@@ -116,30 +136,58 @@ enum gpu_smp_wrapping_t
 
 enum gpu_pixel_format_t
 {
-  gpu_rgb_t = 0x1907,  // GL_RGB
-  gpu_bgr_t = 0x80E0,  // GL_BGR
-  gpu_rgba_t = 0x1908, // GL_RGBA
-  gpu_bgra_t = 0x80E1  // GL_BGRA
+  gpu_d_t = 0x1902,        // GL_DEPTH_COMPONENT
+  gpu_ds_t = 0x84F9,       // GL_DEPTH_STENCIL
+  gpu_r_t = 0x1903,        // GL_RED
+  gpu_rg_t = 0x8227,       // GL_RG
+  gpu_rgb_t = 0x1907,      // GL_RGB
+  gpu_bgr_t = 0x80E0,      // GL_BGR
+  gpu_rgba_t = 0x1908,     // GL_RGBA
+  gpu_bgra_t = 0x80E1,     // GL_BGRA
+  gpu_r_int_t = 0x8D94,    // GL_RED_INTEGER
+  gpu_rg_int_t = 0x8228,   // GL_RG_INTEGER
+  gpu_rgb_int_t = 0x8D98,  // GL_RGB_INTEGER
+  gpu_rgba_int_t = 0x8D99  // GL_RGBA_INTEGER
 };
 
 enum gpu_pixel_t
 {
-  gpu_i8_t = 0x1400,  // GL_BYTE
-  gpu_i16_t = 0x1402, // GL_SHORT
-  gpu_i32_t = 0x1404, // GL_INT
-  gpu_u8_t = 0x1401,  // GL_UNSIGNED_BYTE
-  gpu_u16_t = 0x1403, // GL_UNSIGNED_SHORT
-  gpu_u32_t = 0x1405, // GL_UNSIGNED_INT
-  gpu_f32_t = 0x1406  // GL_FLOAT
+  gpu_i8_t = 0x1400,             // GL_BYTE
+  gpu_i16_t = 0x1402,            // GL_SHORT
+  gpu_i32_t = 0x1404,            // GL_INT
+  gpu_u8_t = 0x1401,             // GL_UNSIGNED_BYTE
+  gpu_u16_t = 0x1403,            // GL_UNSIGNED_SHORT
+  gpu_u32_t = 0x1405,            // GL_UNSIGNED_INT
+  gpu_f16_t = 0x140B,            // GL_HALF_FLOAT
+  gpu_f32_t = 0x1406,            // GL_FLOAT
+  gpu_f11f11f10_t = 0x8C3B,      // GL_UNSIGNED_INT_10F_11F_11F_REV
+  gpu_b10b10b10b2_t = 0x8368,    // GL_UNSIGNED_INT_2_10_10_10_REV
+  gpu_u24u8_t = 0x84FA           // GL_UNSIGNED_INT_24_8
 };
 
+static inline bool gpu_has_ext(const char * _Nonnull extension)
+{
+  int32_t supported_count = 0;
+  glGetIntegerv(33309, &supported_count); // GL_NUM_EXTENSIONS
+
+  for (uint32_t i = 0; i < (uint32_t)supported_count; ++i)
+  {
+    const char * supported = glGetStringi(7939, i); // GL_EXTENSIONS
+    if (supported && SDL_strcmp(supported, extension) == 0)
+      return true;
+  }
+
+  return false;
+}
+
 static inline void gpu_check_exts(
     int32_t extensions_count, const char * _Nonnull * _Nonnull extensions)
 {
   for (ptrdiff_t i = 0; i < extensions_count; ++i)
   {
-    if (!SDL_GL_ExtensionSupported(extensions[i]))
+    if (!gpu_has_ext(extensions[i]))
     {
+      SDL_Log("ERROR: Unsupported OpenGL Extension: %s", extensions[i]);
       SDL_ShowSimpleMessageBox(
           SDL_MESSAGEBOX_ERROR, "ERROR: Unsupported OpenGL Extension",
           extensions[i], NULL);
@@ -147,37 +195,104 @@ static inline void gpu_check_exts(
   }
 }
 
-static inline uint32_t gpu_window(
-    const char * _Nonnull window_title, int32_t window_width,
-    int32_t window_height, int32_t msaa_samples, uint32_t sdl_init_flags,
-    uint32_t sdl_window_flags, SDL_Window * _Nullable * _Nonnull sdl_window,
-    void * _Nullable * _Nullable sdl_glcontext)
+static inline uint32_t
+gpu_load(void * _Nullable (*_Nonnull get_proc_address)(const char * _Nonnull))
 {
-  if (SDL_Init(SDL_INIT_VIDEO | sdl_init_flags))
-    return 1;
-
-  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
-  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
-  SDL_GL_SetAttribute(SDL_GL_MULTISAMPLEBUFFERS, 1);
-  SDL_GL_SetAttribute(SDL_GL_MULTISAMPLESAMPLES, msaa_samples);
-  SDL_GL_SetAttribute(SDL_GL_FRAMEBUFFER_SRGB_CAPABLE, 1);
-
-  *sdl_window = SDL_CreateWindow(
-      window_title, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
-      window_width, window_height, SDL_WINDOW_OPENGL | sdl_window_flags);
-
-  if (*sdl_window == NULL)
-    return 1;
-
-  void * glcontext = SDL_GL_CreateContext(*sdl_window);
-
-  if (glcontext == NULL)
-    return 1;
+  // clang-format off
+  glAttachShader = get_proc_address("glAttachShader");
+  glBeginQuery = get_proc_address("glBeginQuery");
+  glBeginTransformFeedback = get_proc_address("glBeginTransformFeedback");
+  glBindBuffer = get_proc_address("glBindBuffer");
+  glBindFramebuffer = get_proc_address("glBindFramebuffer");
+  glBindProgramPipeline = get_proc_address("glBindProgramPipeline");
+  glBindSamplers = get_proc_address("glBindSamplers");
+  glBindTextures = get_proc_address("glBindTextures");
+  glBindTransformFeedback = get_proc_address("glBindTransformFeedback");
+  glBlendFuncSeparate = get_proc_address("glBlendFuncSeparate");
+  glBlitNamedFramebuffer = get_proc_address("glBlitNamedFramebuffer");
+  glClear = get_proc_address("glClear");
+  glClearColor = get_proc_address("glClearColor");
+  glClearNamedFramebufferfv = get_proc_address("glClearNamedFramebufferfv");
+  glClientWaitSync = get_proc_address("glClientWaitSync");
+  glCompileShader = get_proc_address("glCompileShader");
+  glCreateBuffers = get_proc_address("glCreateBuffers");
+  glCreateFramebuffers = get_proc_address("glCreateFramebuffers");
+  glCreateProgram = get_proc_address("glCreateProgram");
+  glCreateProgramPipelines = get_proc_address("glCreateProgramPipelines");
+  glCreateQueries = get_proc_address("glCreateQueries");
+  glCreateSamplers = get_proc_address("glCreateSamplers");
+  glCreateShader = get_proc_address("glCreateShader");
+  glCreateTextures = get_proc_address("glCreateTextures");
+  glCreateTransformFeedbacks = get_proc_address("glCreateTransformFeedbacks");
+  glDebugMessageCallback = get_proc_address("glDebugMessageCallback");
+  glDeleteBuffers = get_proc_address("glDeleteBuffers");
+  glDeleteFramebuffers = get_proc_address("glDeleteFramebuffers");
+  glDeleteProgram = get_proc_address("glDeleteProgram");
+  glDeleteProgramPipelines = get_proc_address("glDeleteProgramPipelines");
+  glDeleteQueries = get_proc_address("glDeleteQueries");
+  glDeleteSamplers = get_proc_address("glDeleteSamplers");
+  glDeleteShader = get_proc_address("glDeleteShader");
+  glDeleteSync = get_proc_address("glDeleteSync");
+  glDeleteTextures = get_proc_address("glDeleteTextures");
+  glDeleteTransformFeedbacks = get_proc_address("glDeleteTransformFeedbacks");
+  glDetachShader = get_proc_address("glDetachShader");
+  glDisable = get_proc_address("glDisable");
+  glDrawArraysInstancedBaseInstance = get_proc_address("glDrawArraysInstancedBaseInstance");
+  glEnable = get_proc_address("glEnable");
+  glEndQuery = get_proc_address("glEndQuery");
+  glEndTransformFeedback = get_proc_address("glEndTransformFeedback");
+  glFenceSync = get_proc_address("glFenceSync");
+  glFinish = get_proc_address("glFinish");
+  glFlush = get_proc_address("glFlush");
+  glGenerateTextureMipmap = get_proc_address("glGenerateTextureMipmap");
+  glGenTextures = get_proc_address("glGenTextures");
+  glGetIntegerv = get_proc_address("glGetIntegerv");
+  glGetProgramBinary = get_proc_address("glGetProgramBinary");
+  glGetProgramiv = get_proc_address("glGetProgramiv");
+  glGetQueryObjectiv = get_proc_address("glGetQueryObjectiv");
+  glGetQueryObjectui64v = get_proc_address("glGetQueryObjectui64v");
+  glGetString = get_proc_address("glGetString");
+  glGetStringi = get_proc_address("glGetStringi");
+  glGetTextureLevelParameteriv = get_proc_address("glGetTextureLevelParameteriv");
+  glGetTextureSubImage = get_proc_address("glGetTextureSubImage");
+  glLinkProgram = get_proc_address("glLinkProgram");
+  glMapNamedBufferRange = get_proc_address("glMapNamedBufferRange");
+  glMultiDrawArraysIndirect = get_proc_address("glMultiDrawArraysIndirect");
+  glNamedBufferStorage = get_proc_address("glNamedBufferStorage");
+  glNamedFramebufferDrawBuffer = get_proc_address("glNamedFramebufferDrawBuffer");
+  glNamedFramebufferDrawBuffers = get_proc_address("glNamedFramebufferDrawBuffers");
+  glNamedFramebufferReadBuffer = get_proc_address("glNamedFramebufferReadBuffer");
+  glNamedFramebufferTextureLayer = get_proc_address("glNamedFramebufferTextureLayer");
+  glProgramBinary = get_proc_address("glProgramBinary");
+  glProgramParameteri = get_proc_address("glProgramParameteri");
+  glProgramUniform1dv = get_proc_address("glProgramUniform1dv");
+  glProgramUniform1fv = get_proc_address("glProgramUniform1fv");
+  glProgramUniform1iv = get_proc_address("glProgramUniform1iv");
+  glProgramUniform1uiv = get_proc_address("glProgramUniform1uiv");
+  glProgramUniform2fv = get_proc_address("glProgramUniform2fv");
+  glProgramUniform3fv = get_proc_address("glProgramUniform3fv");
+  glProgramUniform4fv = get_proc_address("glProgramUniform4fv");
+  glQueryCounter = get_proc_address("glQueryCounter");
+  glSamplerParameteri = get_proc_address("glSamplerParameteri");
+  glScissor = get_proc_address("glScissor");
+  glShaderSource = get_proc_address("glShaderSource");
+  glTextureBufferRange = get_proc_address("glTextureBufferRange");
+  glTextureParameteriv = get_proc_address("glTextureParameteriv");
+  glTextureStorage3D = get_proc_address("glTextureStorage3D");
+  glTextureStorage3DMultisample = get_proc_address("glTextureStorage3DMultisample");
+  glTextureSubImage3D = get_proc_address("glTextureSubImage3D");
+  glTextureView = get_proc_address("glTextureView");
+  glTransformFeedbackBufferRange = get_proc_address("glTransformFeedbackBufferRange");
+  glTransformFeedbackVaryings = get_proc_address("glTransformFeedbackVaryings");
+  glUseProgramStages = get_proc_address("glUseProgramStages");
+  glViewport = get_proc_address("glViewport");
+  // clang-format on
 
-  if (sdl_glcontext)
-    *sdl_glcontext = glcontext;
+#ifdef GPU_TRACE
+  gpu_trace_install();
+#endif
 
-  if (SDL_GL_LoadLibrary(NULL))
+  if (glGetIntegerv == NULL || glGetStringi == NULL)
     return 1;
 
   const char * extensions[] = {
@@ -208,79 +323,12 @@ static inline uint32_t gpu_window(
 
   gpu_check_exts(sizeof(extensions) / sizeof(extensions[0]), extensions);
 
-  // clang-format off
-  glAttachShader = SDL_GL_GetProcAddress("glAttachShader");
-  glBeginTransformFeedback = SDL_GL_GetProcAddress("glBeginTransformFeedback");
-  glBindFramebuffer = SDL_GL_GetProcAddress("glBindFramebuffer");
-  glBindProgramPipeline = SDL_GL_GetProcAddress("glBindProgramPipeline");
-  glBindSamplers = SDL_GL_GetProcAddress("glBindSamplers");
-  glBindTextures = SDL_GL_GetProcAddress("glBindTextures");
-  glBindTransformFeedback = SDL_GL_GetProcAddress("glBindTransformFeedback");
-  glBlitNamedFramebuffer = SDL_GL_GetProcAddress("glBlitNamedFramebuffer");
-  glClear = SDL_GL_GetProcAddress("glClear");
-  glClearColor = SDL_GL_GetProcAddress("glClearColor");
-  glCompileShader = SDL_GL_GetProcAddress("glCompileShader");
-  glCreateBuffers = SDL_GL_GetProcAddress("glCreateBuffers");
-  glCreateFramebuffers = SDL_GL_GetProcAddress("glCreateFramebuffers");
-  glCreateProgram = SDL_GL_GetProcAddress("glCreateProgram");
-  glCreateProgramPipelines = SDL_GL_GetProcAddress("glCreateProgramPipelines");
-  glCreateSamplers = SDL_GL_GetProcAddress("glCreateSamplers");
-  glCreateShader = SDL_GL_GetProcAddress("glCreateShader");
-  glCreateTextures = SDL_GL_GetProcAddress("glCreateTextures");
-  glCreateTransformFeedbacks = SDL_GL_GetProcAddress("glCreateTransformFeedbacks");
-  glDebugMessageCallback = SDL_GL_GetProcAddress("glDebugMessageCallback");
-  glDeleteBuffers = SDL_GL_GetProcAddress("glDeleteBuffers");
-  glDeleteFramebuffers = SDL_GL_GetProcAddress("glDeleteFramebuffers");
-  glDeleteProgram = SDL_GL_GetProcAddress("glDeleteProgram");
-  glDeleteProgramPipelines = SDL_GL_GetProcAddress("glDeleteProgramPipelines");
-  glDeleteSamplers = SDL_GL_GetProcAddress("glDeleteSamplers");
-  glDeleteShader = SDL_GL_GetProcAddress("glDeleteShader");
-  glDeleteTextures = SDL_GL_GetProcAddress("glDeleteTextures");
-  glDeleteTransformFeedbacks = SDL_GL_GetProcAddress("glDeleteTransformFeedbacks");
-  glDetachShader = SDL_GL_GetProcAddress("glDetachShader");
-  glDisable = SDL_GL_GetProcAddress("glDisable");
-  glDrawArraysInstancedBaseInstance = SDL_GL_GetProcAddress("glDrawArraysInstancedBaseInstance");
-  glEnable = SDL_GL_GetProcAddress("glEnable");
-  glEndTransformFeedback = SDL_GL_GetProcAddress("glEndTransformFeedback");
-  glFinish = SDL_GL_GetProcAddress("glFinish");
-  glGenerateTextureMipmap = SDL_GL_GetProcAddress("glGenerateTextureMipmap");
-  glGenTextures = SDL_GL_GetProcAddress("glGenTextures");
-  glGetTextureSubImage = SDL_GL_GetProcAddress("glGetTextureSubImage");
-  glLinkProgram = SDL_GL_GetProcAddress("glLinkProgram");
-  glMapNamedBufferRange = SDL_GL_GetProcAddress("glMapNamedBufferRange");
-  glNamedBufferStorage = SDL_GL_GetProcAddress("glNamedBufferStorage");
-  glNamedFramebufferDrawBuffer = SDL_GL_GetProcAddress("glNamedFramebufferDrawBuffer");
-  glNamedFramebufferDrawBuffers = SDL_GL_GetProcAddress("glNamedFramebufferDrawBuffers");
-  glNamedFramebufferReadBuffer = SDL_GL_GetProcAddress("glNamedFramebufferReadBuffer");
-  glNamedFramebufferTextureLayer = SDL_GL_GetProcAddress("glNamedFramebufferTextureLayer");
-  glProgramParameteri = SDL_GL_GetProcAddress("glProgramParameteri");
-  glProgramUniform1dv = SDL_GL_GetProcAddress("glProgramUniform1dv");
-  glProgramUniform1fv = SDL_GL_GetProcAddress("glProgramUniform1fv");
-  glProgramUniform1iv = SDL_GL_GetProcAddress("glProgramUniform1iv");
-  glProgramUniform1uiv = SDL_GL_GetProcAddress("glProgramUniform1uiv");
-  glProgramUniform2fv = SDL_GL_GetProcAddress("glProgramUniform2fv");
-  glProgramUniform3fv = SDL_GL_GetProcAddress("glProgramUniform3fv");
-  glProgramUniform4fv = SDL_GL_GetProcAddress("glProgramUniform4fv");
-  glSamplerParameteri = SDL_GL_GetProcAddress("glSamplerParameteri");
-  glScissor = SDL_GL_GetProcAddress("glScissor");
-  glShaderSource = SDL_GL_GetProcAddress("glShaderSource");
-  glTextureBufferRange = SDL_GL_GetProcAddress("glTextureBufferRange");
-  glTextureStorage3D = SDL_GL_GetProcAddress("glTextureStorage3D");
-  glTextureStorage3DMultisample = SDL_GL_GetProcAddress("glTextureStorage3DMultisample");
-  glTextureSubImage3D = SDL_GL_GetProcAddress("glTextureSubImage3D");
-  glTextureView = SDL_GL_GetProcAddress("glTextureView");
-  glTransformFeedbackBufferRange = SDL_GL_GetProcAddress("glTransformFeedbackBufferRange");
-  glTransformFeedbackVaryings = SDL_GL_GetProcAddress("glTransformFeedbackVaryings");
-  glUseProgramStages = SDL_GL_GetProcAddress("glUseProgramStages");
-  glViewport = SDL_GL_GetProcAddress("glViewport");
-  // clang-format on
-
   void (*_Nonnull glCreateVertexArrays)(int32_t, uint32_t * _Nullable) =
-      SDL_GL_GetProcAddress("glCreateVertexArrays");
+      get_proc_address("glCreateVertexArrays");
   void (*_Nonnull glBindVertexArray)(uint32_t) =
-      SDL_GL_GetProcAddress("glBindVertexArray");
+      get_proc_address("glBindVertexArray");
   void (*_Nonnull glBlendFunc)(uint32_t, uint32_t) =
-      SDL_GL_GetProcAddress("glBlendFunc");
+      get_proc_address("glBlendFunc");
 
   uint32_t vao;
   glCreateVertexArrays(1, &vao);
@@ -303,26 +351,307 @@ static inline uint32_t gpu_window(
   return 0;
 }
 
+static inline uint32_t gpu_window(
+    const char * _Nonnull window_title, int32_t window_width,
+    int32_t window_height, int32_t msaa_samples, uint32_t sdl_init_flags,
+    uint32_t sdl_window_flags, SDL_Window * _Nullable * _Nonnull sdl_window,
+    void * _Nullable * _Nullable sdl_glcontext)
+{
+  if (SDL_Init(SDL_INIT_VIDEO | sdl_init_flags))
+    return 1;
+
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+  SDL_GL_SetAttribute(SDL_GL_MULTISAMPLEBUFFERS, 1);
+  SDL_GL_SetAttribute(SDL_GL_MULTISAMPLESAMPLES, msaa_samples);
+  SDL_GL_SetAttribute(SDL_GL_FRAMEBUFFER_SRGB_CAPABLE, 1);
+
+  *sdl_window = SDL_CreateWindow(
+      window_title, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+      window_width, window_height, SDL_WINDOW_OPENGL | sdl_window_flags);
+
+  if (*sdl_window == NULL)
+    return 1;
+
+  void * glcontext = SDL_GL_CreateContext(*sdl_window);
+
+  if (glcontext == NULL)
+    return 1;
+
+  if (sdl_glcontext)
+    *sdl_glcontext = glcontext;
+
+  if (SDL_GL_LoadLibrary(NULL))
+    return 1;
+
+  return gpu_load(SDL_GL_GetProcAddress);
+}
+
+// Windowless EGL context (surfaceless, or 1x1 pbuffer as a fallback) with the
+// same function table and global state as gpu_window. Render into gpu_fbo.
+static inline uint32_t gpu_headless(
+    uint32_t sdl_init_flags, void * _Nullable * _Nullable egl_display,
+    void * _Nullable * _Nullable egl_context)
+{
+  if (sdl_init_flags && SDL_Init(sdl_init_flags))
+    return 1;
+
+  void * egl = SDL_LoadObject("libEGL.so.1");
+
+  if (egl == NULL)
+    egl = SDL_LoadObject("libEGL.dll");
+
+  if (egl == NULL)
+    return 1;
+
+  // clang-format off
+  void * _Nullable (* _Nullable eglGetProcAddress)(const char * _Nonnull) = SDL_LoadFunction(egl, "eglGetProcAddress");
+  void * _Nullable (* _Nullable eglGetDisplay)(void * _Nullable) = SDL_LoadFunction(egl, "eglGetDisplay");
+  uint32_t (* _Nullable eglInitialize)(void * _Nonnull, int32_t * _Nullable, int32_t * _Nullable) = SDL_LoadFunction(egl, "eglInitialize");
+  uint32_t (* _Nullable eglBindAPI)(uint32_t) = SDL_LoadFunction(egl, "eglBindAPI");
+  uint32_t (* _Nullable eglChooseConfig)(void * _Nonnull, const int32_t * _Nonnull, void * _Nullable * _Nonnull, int32_t, int32_t * _Nonnull) = SDL_LoadFunction(egl, "eglChooseConfig");
+  void * _Nullable (* _Nullable eglCreateContext)(void * _Nonnull, void * _Nullable, void * _Nullable, const int32_t * _Nonnull) = SDL_LoadFunction(egl, "eglCreateContext");
+  void * _Nullable (* _Nullable eglCreatePbufferSurface)(void * _Nonnull, void * _Nullable, const int32_t * _Nonnull) = SDL_LoadFunction(egl, "eglCreatePbufferSurface");
+  uint32_t (* _Nullable eglMakeCurrent)(void * _Nonnull, void * _Nullable, void * _Nullable, void * _Nullable) = SDL_LoadFunction(egl, "eglMakeCurrent");
+  // clang-format on
+
+  if (eglGetProcAddress == NULL || eglGetDisplay == NULL ||
+      eglInitialize == NULL || eglBindAPI == NULL || eglChooseConfig == NULL ||
+      eglCreateContext == NULL || eglCreatePbufferSurface == NULL ||
+      eglMakeCurrent == NULL)
+    return 1;
+
+  void * _Nullable (*_Nullable eglGetPlatformDisplayEXT)(
+      uint32_t, void * _Nullable, const int32_t * _Nullable) =
+      eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+  void * display = NULL;
+  int32_t major = 0, minor = 0;
+
+  if (eglGetPlatformDisplayEXT)
+    display = eglGetPlatformDisplayEXT(
+        0x31DD, NULL, NULL); // EGL_PLATFORM_SURFACELESS_MESA
+
+  if (display == NULL || !eglInitialize(display, &major, &minor))
+  {
+    display = eglGetDisplay(NULL); // EGL_DEFAULT_DISPLAY
+    if (display == NULL || !eglInitialize(display, &major, &minor))
+      return 1;
+  }
+
+  if (!eglBindAPI(0x30A2)) // EGL_OPENGL_API
+    return 1;
+
+  // clang-format off
+  const int32_t config_attribs[] =
+  {
+    0x3033, 0x0001, // EGL_SURFACE_TYPE, EGL_PBUFFER_BIT
+    0x3040, 0x0008, // EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT
+    0x3038          // EGL_NONE
+  };
+
+  const int32_t context_attribs[] =
+  {
+    0x3098, 3,      // EGL_CONTEXT_MAJOR_VERSION
+    0x30FB, 3,      // EGL_CONTEXT_MINOR_VERSION
+    0x30FD, 0x0001, // EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT
+    0x3038          // EGL_NONE
+  };
+
+  const int32_t pbuffer_attribs[] =
+  {
+    0x3057, 1, // EGL_WIDTH
+    0x3056, 1, // EGL_HEIGHT
+    0x3038     // EGL_NONE
+  };
+  // clang-format on
+
+  void * config = NULL;
+  int32_t config_count = 0;
+
+  if (!eglChooseConfig(display, config_attribs, &config, 1, &config_count) ||
+      config_count == 0)
+    return 1;
+
+  void * context = eglCreateContext(display, config, NULL, context_attribs);
+
+  if (context == NULL)
+    return 1;
+
+  if (!eglMakeCurrent(display, NULL, NULL, context))
+  {
+    void * pbuffer = eglCreatePbufferSurface(display, config, pbuffer_attribs);
+    if (pbuffer == NULL || !eglMakeCurrent(display, pbuffer, pbuffer, context))
+      return 1;
+  }
+
+  if (egl_display)
+    *egl_display = display;
+
+  if (egl_context)
+    *egl_context = context;
+
+  return gpu_load(eglGetProcAddress);
+}
+
+#ifndef GPU_MEM_SUB_BYTES
+#define GPU_MEM_SUB_BYTES (64 * 1024 * 1024)
+#endif
+
+#ifndef GPU_MEM_SUB_MAX
+#define GPU_MEM_SUB_MAX 64
+#endif
+
+#define GPU_MEM_SUB_CLASS_MIN 8  // 256 bytes
+#define GPU_MEM_SUB_CLASS_MAX 22 // 4 MiB
+
+// Every gpu memory pointer is preceded by a 16 byte header:
+// [0] size class, 0 for dedicated gpu_malloc buffers
+// [1] reserved
+// [2] byte offset of the pointer in its buffer
+// [3] buffer id
+
+static struct
+{
+  int32_t mem_count;
+  uint32_t mem_id[GPU_MEM_SUB_MAX];
+  uint8_t * _Nullable mem_ptr[GPU_MEM_SUB_MAX];
+  ptrdiff_t mem_used;
+  void * _Nullable free_list[GPU_MEM_SUB_CLASS_MAX + 1];
+} gpu_mem_sub = {};
+
+static inline uint32_t gpu_mem_id(const void * _Nonnull gpu_mem_ptr)
+{
+  return ((const uint32_t *)gpu_mem_ptr)[-1];
+}
+
+static inline ptrdiff_t gpu_mem_first(const void * _Nonnull gpu_mem_ptr)
+{
+  return ((const uint32_t *)gpu_mem_ptr)[-2];
+}
+
 static inline void * _Nullable gpu_malloc(ptrdiff_t bytes)
 {
   uint32_t mem_id = 0;
   glCreateBuffers(1, &mem_id);
 
-  ptrdiff_t size = 4 + bytes;
+  ptrdiff_t size = 16 + bytes;
 
-  glNamedBufferStorage(mem_id, size, NULL, 194);
-  void * p = glMapNamedBufferRange(mem_id, 0, size, 194);
+  glNamedBufferStorage(mem_id, size, NULL, 195);
+  void * p = glMapNamedBufferRange(mem_id, 0, size, 195);
 
   if (p == NULL)
+  {
+    glDeleteBuffers(1, &mem_id);
     return NULL;
+  }
 
   uint32_t * p_u32 = p;
-  p_u32[0] = mem_id;
-  p_u32 += 1;
+  p_u32[0] = 0;
+  p_u32[1] = 0;
+  p_u32[2] = 16;
+  p_u32[3] = mem_id;
+  p_u32 += 4;
 
   return (void *)p_u32;
 }
 
+static inline uint32_t * _Nonnull gpu_mem_sub_block(int32_t size_class)
+{
+  ptrdiff_t used = gpu_mem_sub.mem_used;
+  int32_t i = gpu_mem_sub.mem_count - 1;
+
+  uint32_t * p_u32 = (uint32_t *)(gpu_mem_sub.mem_ptr[i] + used);
+  p_u32[0] = (uint32_t)size_class;
+  p_u32[1] = 0;
+  p_u32[2] = (uint32_t)(used + 16);
+  p_u32[3] = gpu_mem_sub.mem_id[i];
+  p_u32 += 4;
+
+  gpu_mem_sub.mem_used = used + ((ptrdiff_t)1 << size_class);
+
+  return p_u32;
+}
+
+static inline void * _Nullable gpu_malloc_sub(ptrdiff_t bytes)
+{
+  int32_t size_class = GPU_MEM_SUB_CLASS_MIN;
+  while (((ptrdiff_t)1 << size_class) < 16 + bytes)
+    size_class += 1;
+
+  if (size_class > GPU_MEM_SUB_CLASS_MAX)
+    return gpu_malloc(bytes);
+
+  void * p = gpu_mem_sub.free_list[size_class];
+
+  if (p)
+  {
+    gpu_mem_sub.free_list[size_class] = *(void **)p;
+    return p;
+  }
+
+  ptrdiff_t block_bytes = (ptrdiff_t)1 << size_class;
+
+  if (gpu_mem_sub.mem_count == 0 ||
+      gpu_mem_sub.mem_used + block_bytes > GPU_MEM_SUB_BYTES)
+  {
+    if (gpu_mem_sub.mem_count == GPU_MEM_SUB_MAX)
+      return NULL;
+
+    // Hand the tail of the full buffer over to the free lists.
+    while (gpu_mem_sub.mem_count &&
+           GPU_MEM_SUB_BYTES - gpu_mem_sub.mem_used >=
+               ((ptrdiff_t)1 << GPU_MEM_SUB_CLASS_MIN))
+    {
+      int32_t tail_class = GPU_MEM_SUB_CLASS_MAX;
+      while (((ptrdiff_t)1 << tail_class) >
+             GPU_MEM_SUB_BYTES - gpu_mem_sub.mem_used)
+        tail_class -= 1;
+
+      void * tail = gpu_mem_sub_block(tail_class);
+      *(void **)tail = gpu_mem_sub.free_list[tail_class];
+      gpu_mem_sub.free_list[tail_class] = tail;
+    }
+
+    uint32_t mem_id = 0;
+    glCreateBuffers(1, &mem_id);
+
+    glNamedBufferStorage(mem_id, GPU_MEM_SUB_BYTES, NULL, 195);
+    void * mem = glMapNamedBufferRange(mem_id, 0, GPU_MEM_SUB_BYTES, 195);
+
+    if (mem == NULL)
+    {
+      glDeleteBuffers(1, &mem_id);
+      return NULL;
+    }
+
+    gpu_mem_sub.mem_id[gpu_mem_sub.mem_count] = mem_id;
+    gpu_mem_sub.mem_ptr[gpu_mem_sub.mem_count] = mem;
+    gpu_mem_sub.mem_count += 1;
+    gpu_mem_sub.mem_used = 0;
+  }
+
+  return gpu_mem_sub_block(size_class);
+}
+
+static inline void gpu_free(void * _Nullable gpu_mem_ptr)
+{
+  if (gpu_mem_ptr == NULL)
+    return;
+
+  uint32_t size_class = ((uint32_t *)gpu_mem_ptr)[-4];
+
+  if (size_class == 0)
+  {
+    uint32_t mem_id = gpu_mem_id(gpu_mem_ptr);
+    glDeleteBuffers(1, &mem_id);
+    return;
+  }
+
+  *(void **)gpu_mem_ptr = gpu_mem_sub.free_list[size_class];
+  gpu_mem_sub.free_list[size_class] = gpu_mem_ptr;
+}
+
 static inline uint32_t gpu_cast(
     void * _Nonnull gpu_mem_ptr, enum gpu_tex_mem_format_t format,
     ptrdiff_t bytes_first, ptrdiff_t bytes_count)
@@ -330,13 +659,98 @@ static inline uint32_t gpu_cast(
   uint32_t tex_id = 0;
   glCreateTextures(35882, 1, &tex_id);
 
-  uint32_t mem_id = ((uint32_t *)gpu_mem_ptr)[-1];
-
-  glTextureBufferRange(tex_id, format, mem_id, 4 + bytes_first, bytes_count);
+  glTextureBufferRange(
+      tex_id, format, gpu_mem_id(gpu_mem_ptr),
+      gpu_mem_first(gpu_mem_ptr) + bytes_first, bytes_count);
 
   return tex_id;
 }
 
+static inline void * _Nonnull gpu_fence()
+{
+  return glFenceSync(37143, 0); // GL_SYNC_GPU_COMMANDS_COMPLETE
+}
+
+static inline void gpu_wait(void * _Nullable fence)
+{
+  if (fence == NULL)
+    return;
+
+  // GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_EXPIRED
+  while (glClientWaitSync(fence, 1, 1000000) == 37147)
+    ;
+
+  glDeleteSync(fence);
+}
+
+static inline bool gpu_poll(void * _Nonnull fence)
+{
+  // GL_SYNC_FLUSH_COMMANDS_BIT
+  uint32_t status = glClientWaitSync(fence, 1, 0);
+
+  // GL_ALREADY_SIGNALED, GL_CONDITION_SATISFIED
+  return status == 37146 || status == 37148;
+}
+
+#ifndef GPU_RING_FRAMES_MAX
+#define GPU_RING_FRAMES_MAX 8
+#endif
+
+struct gpu_ring_t
+{
+  uint8_t * _Nullable mem;
+  ptrdiff_t frame_bytes;
+  int32_t frame_count;
+  int32_t frame;
+  void * _Nullable fence[GPU_RING_FRAMES_MAX];
+};
+
+static inline void * _Nullable gpu_ring(
+    struct gpu_ring_t * _Nonnull ring, ptrdiff_t frame_bytes,
+    int32_t frame_count)
+{
+  *ring = (struct gpu_ring_t){};
+
+  if (frame_count < 1)
+    return NULL;
+
+  if (frame_count > GPU_RING_FRAMES_MAX)
+    frame_count = GPU_RING_FRAMES_MAX;
+
+  ring->frame_bytes = (frame_bytes + 255) & ~(ptrdiff_t)255;
+  ring->frame_count = frame_count;
+  ring->frame = frame_count - 1;
+  ring->mem = gpu_malloc(ring->frame_bytes * frame_count);
+
+  return ring->mem;
+}
+
+static inline void * _Nonnull gpu_ring_begin(struct gpu_ring_t * _Nonnull ring)
+{
+  ring->frame = (ring->frame + 1) % ring->frame_count;
+
+  gpu_wait(ring->fence[ring->frame]);
+  ring->fence[ring->frame] = NULL;
+
+  return ring->mem + ring->frame * ring->frame_bytes;
+}
+
+static inline void gpu_ring_end(struct gpu_ring_t * _Nonnull ring)
+{
+  ring->fence[ring->frame] = gpu_fence();
+}
+
+static inline void gpu_ring_cast(
+    struct gpu_ring_t * _Nonnull ring, uint32_t tex_id,
+    enum gpu_tex_mem_format_t format, ptrdiff_t bytes_first,
+    ptrdiff_t bytes_count)
+{
+  glTextureBufferRange(
+      tex_id, format, gpu_mem_id(ring->mem),
+      gpu_mem_first(ring->mem) + ring->frame * ring->frame_bytes + bytes_first,
+      bytes_count);
+}
+
 static inline uint32_t gpu_malloc_tex(
     bool is_cubemap, enum gpu_tex_format_t format, int32_t width,
     int32_t height, int32_t layer_count, int32_t mipmap_count)
@@ -390,11 +804,147 @@ static inline uint32_t gpu_cast_tex(
 #define gpu_cast_cbm(tex_id, format, layer_first, layer_count, mipmap_first, mipmap_count) gpu_cast_tex(true, tex_id, format, layer_first, layer_count, mipmap_first, mipmap_count)
 // clang-format on
 
-// clang-format off
-#define gpu_get(tex_id, layer, x, y, width, height, pixel_format, pixel_type, pixels_bytes, pixels) glGetTextureSubImage(tex_id, 0, x, y, layer, width, height, 1, pixel_format, pixel_type, pixels_bytes, pixels)
-#define gpu_set(tex_id, layer, x, y, width, height, pixel_format, pixel_type, pixels) glTextureSubImage3D(tex_id, 0, x, y, layer, width, height, 1, pixel_format, pixel_type, pixels)
+static inline bool gpu_pixel_check(
+    uint32_t tex_format, enum gpu_pixel_format_t pixel_format,
+    enum gpu_pixel_t pixel_type)
+{
+  bool is_int_format =
+      pixel_format == gpu_r_int_t || pixel_format == gpu_rg_int_t ||
+      pixel_format == gpu_rgb_int_t || pixel_format == gpu_rgba_int_t;
+  bool is_depth_format = pixel_format == gpu_d_t || pixel_format == gpu_ds_t;
+  bool is_float_type = pixel_type == gpu_f16_t || pixel_type == gpu_f32_t ||
+                       pixel_type == gpu_f11f11f10_t;
+
+  if (pixel_type == gpu_f11f11f10_t && pixel_format != gpu_rgb_t)
+    return false;
+
+  if (pixel_type == gpu_b10b10b10b2_t && pixel_format != gpu_rgba_t &&
+      pixel_format != gpu_bgra_t && pixel_format != gpu_rgba_int_t)
+    return false;
+
+  if ((pixel_type == gpu_u24u8_t) != (pixel_format == gpu_ds_t))
+    return false;
+
+  switch (tex_format)
+  {
+  case (gpu_d_b16_t):
+  case (gpu_d_f32_t):
+    return pixel_format == gpu_d_t;
+  case (gpu_ds_b24_u8_t):
+    return is_depth_format;
+  case (gpu_r_i32_t):
+  case (gpu_r_u32_t):
+  case (gpu_x_i8_t):
+  case (gpu_x_i16_t):
+  case (gpu_x_u8_t):
+  case (gpu_x_u16_t):
+  case (gpu_xy_i8_t):
+  case (gpu_xy_i16_t):
+  case (gpu_xy_i32_t):
+  case (gpu_xy_u8_t):
+  case (gpu_xy_u16_t):
+  case (gpu_xy_u32_t):
+  case (gpu_xyz_i32_t):
+  case (gpu_xyz_u32_t):
+  case (gpu_xyzw_i8_t):
+  case (gpu_xyzw_i16_t):
+  case (gpu_xyzw_i32_t):
+  case (gpu_xyzw_u8_t):
+  case (gpu_xyzw_u16_t):
+  case (gpu_xyzw_u32_t):
+    return is_int_format && !is_float_type;
+  default:
+    return !is_int_format && !is_depth_format;
+  }
+}
+
+static inline bool gpu_pixel_check_tex(
+    uint32_t tex_id, enum gpu_pixel_format_t pixel_format,
+    enum gpu_pixel_t pixel_type)
+{
+#ifndef RELEASE
+  int32_t tex_format = 0;
+  glGetTextureLevelParameteriv(
+      tex_id, 0, 4099, &tex_format); // GL_TEXTURE_INTERNAL_FORMAT
+
+  if (!gpu_pixel_check((uint32_t)tex_format, pixel_format, pixel_type))
+  {
+    SDL_Log(
+        "ERROR: Pixel format 0x%X with type 0x%X doesn't match texture %u of "
+        "format 0x%X",
+        pixel_format, pixel_type, tex_id, tex_format);
+    return false;
+  }
+#endif
+
+  return true;
+}
+
+static inline void gpu_get(
+    uint32_t tex_id, int32_t layer, int32_t x, int32_t y, int32_t width,
+    int32_t height, enum gpu_pixel_format_t pixel_format,
+    enum gpu_pixel_t pixel_type, ptrdiff_t pixels_bytes,
+    void * _Nonnull pixels)
+{
+  if (!gpu_pixel_check_tex(tex_id, pixel_format, pixel_type))
+    return;
+
+  glGetTextureSubImage(
+      tex_id, 0, x, y, layer, width, height, 1, pixel_format, pixel_type,
+      (int32_t)pixels_bytes, pixels);
+}
+
+static inline void gpu_set(
+    uint32_t tex_id, int32_t layer, int32_t x, int32_t y, int32_t width,
+    int32_t height, enum gpu_pixel_format_t pixel_format,
+    enum gpu_pixel_t pixel_type, const void * _Nonnull pixels)
+{
+  if (!gpu_pixel_check_tex(tex_id, pixel_format, pixel_type))
+    return;
+
+  glTextureSubImage3D(
+      tex_id, 0, x, y, layer, width, height, 1, pixel_format, pixel_type,
+      pixels);
+}
+
 #define gpu_mip(tex_id) glGenerateTextureMipmap(tex_id)
-// clang-format on
+
+static inline void * _Nonnull gpu_get_mem(
+    uint32_t tex_id, int32_t layer, int32_t x, int32_t y, int32_t width,
+    int32_t height, enum gpu_pixel_format_t pixel_format,
+    enum gpu_pixel_t pixel_type, ptrdiff_t pixels_bytes,
+    void * _Nonnull gpu_mem_ptr, ptrdiff_t bytes_first)
+{
+  if (!gpu_pixel_check_tex(tex_id, pixel_format, pixel_type))
+    return gpu_fence();
+
+  glBindBuffer(35051, gpu_mem_id(gpu_mem_ptr)); // GL_PIXEL_PACK_BUFFER
+  glGetTextureSubImage(
+      tex_id, 0, x, y, layer, width, height, 1, pixel_format, pixel_type,
+      (int32_t)pixels_bytes,
+      (void *)(gpu_mem_first(gpu_mem_ptr) + bytes_first));
+  glBindBuffer(35051, 0);
+
+  return gpu_fence();
+}
+
+static inline void * _Nonnull gpu_set_mem(
+    uint32_t tex_id, int32_t layer, int32_t x, int32_t y, int32_t width,
+    int32_t height, enum gpu_pixel_format_t pixel_format,
+    enum gpu_pixel_t pixel_type, void * _Nonnull gpu_mem_ptr,
+    ptrdiff_t bytes_first)
+{
+  if (!gpu_pixel_check_tex(tex_id, pixel_format, pixel_type))
+    return gpu_fence();
+
+  glBindBuffer(35052, gpu_mem_id(gpu_mem_ptr)); // GL_PIXEL_UNPACK_BUFFER
+  glTextureSubImage3D(
+      tex_id, 0, x, y, layer, width, height, 1, pixel_format, pixel_type,
+      (const void *)(gpu_mem_first(gpu_mem_ptr) + bytes_first));
+  glBindBuffer(35052, 0);
+
+  return gpu_fence();
+}
 
 static inline void gpu_bmp_img(
     uint32_t tex_id, int32_t width, int32_t height, int32_t layer_count,
@@ -492,21 +1042,169 @@ static inline uint32_t gpu_smp(
   return smp_id;
 }
 
+static inline uint64_t
+gpu_hash(uint64_t hash, const void * _Nullable data, ptrdiff_t bytes)
+{
+  const uint8_t * p = data;
+  for (ptrdiff_t i = 0; i < bytes; ++i)
+  {
+    hash ^= p[i];
+    hash *= 1099511628211ull; // FNV-1a 64
+  }
+  return hash;
+}
+
+static struct
+{
+  char dir[4096];
+  uint64_t seed;
+} gpu_pro_bin = {};
+
+static inline void gpu_pro_cache(const char * _Nullable dir)
+{
+  gpu_pro_bin.dir[0] = 0;
+
+  if (dir == NULL)
+    return;
+
+  // Binaries are named by appending to dir, add the separator if missing
+  size_t length = SDL_strlen(dir);
+  const char * separator =
+      length > 0 && dir[length - 1] != '/' && dir[length - 1] != '\\' ? "/"
+                                                                      : "";
+
+  SDL_snprintf(
+      gpu_pro_bin.dir, sizeof(gpu_pro_bin.dir), "%s%s", dir, separator);
+
+  const char * strings[] = {
+      glGetString(7936), // GL_VENDOR
+      glGetString(7937), // GL_RENDERER
+      glGetString(7938), // GL_VERSION
+  };
+
+  uint64_t seed = 14695981039346656037ull;
+  for (ptrdiff_t i = 0; i < 3; ++i)
+    if (strings[i])
+      seed = gpu_hash(seed, strings[i], (ptrdiff_t)SDL_strlen(strings[i]) + 1);
+
+  gpu_pro_bin.seed = seed;
+}
+
+static inline uint32_t gpu_pro_load(const char * _Nonnull filepath)
+{
+  SDL_RWops * fd = SDL_RWFromFile(filepath, "rb");
+
+  if (fd == NULL)
+    return 0;
+
+  SDL_RWseek(fd, 0, RW_SEEK_END);
+  int64_t bytes = SDL_RWtell(fd) - 4;
+  SDL_RWseek(fd, 0, RW_SEEK_SET);
+
+  uint32_t binary_format = 0;
+  void * binary = bytes > 0 ? SDL_malloc((size_t)bytes) : NULL;
+
+  if (binary == NULL || SDL_RWread(fd, &binary_format, 4, 1) != 1 ||
+      SDL_RWread(fd, binary, (size_t)bytes, 1) != 1)
+  {
+    SDL_free(binary);
+    SDL_RWclose(fd);
+    return 0;
+  }
+
+  SDL_RWclose(fd);
+
+  uint32_t pro_id = glCreateProgram();
+  glProgramParameteri(pro_id, 33368, 1);
+  glProgramBinary(pro_id, binary_format, binary, (int32_t)bytes);
+  SDL_free(binary);
+
+  int32_t link_status = 0;
+  glGetProgramiv(pro_id, 35714, &link_status); // GL_LINK_STATUS
+
+  if (link_status == 0)
+  {
+    glDeleteProgram(pro_id);
+    return 0;
+  }
+
+  return pro_id;
+}
+
+static inline void
+gpu_pro_save(uint32_t pro_id, const char * _Nonnull filepath)
+{
+  int32_t link_status = 0;
+  int32_t bytes = 0;
+  glGetProgramiv(pro_id, 35714, &link_status); // GL_LINK_STATUS
+  glGetProgramiv(pro_id, 34625, &bytes); // GL_PROGRAM_BINARY_LENGTH
+
+  if (link_status == 0 || bytes <= 0)
+    return;
+
+  uint32_t binary_format = 0;
+  void * binary = SDL_malloc((size_t)bytes);
+
+  if (binary == NULL)
+    return;
+
+  glGetProgramBinary(pro_id, bytes, &bytes, &binary_format, binary);
+
+  SDL_RWops * fd = SDL_RWFromFile(filepath, "wb");
+
+  if (fd)
+  {
+    SDL_RWwrite(fd, &binary_format, 4, 1);
+    SDL_RWwrite(fd, binary, (size_t)bytes, 1);
+    SDL_RWclose(fd);
+  }
+
+  SDL_free(binary);
+}
+
 static inline uint32_t gpu_pro(
     enum gpu_shader_t shader_type, const char * _Nonnull shader_string,
     int32_t feedback_count, const char * _Nullable * _Nullable feedback_names)
 {
+  char filepath[4096 + 32] = {};
+
+  if (gpu_pro_bin.dir[0])
+  {
+    uint64_t hash = gpu_pro_bin.seed;
+    hash = gpu_hash(hash, &shader_type, sizeof(shader_type));
+    hash = gpu_hash(hash, shader_string, (ptrdiff_t)SDL_strlen(shader_string));
+    for (ptrdiff_t i = 0; i < feedback_count; ++i)
+      if (feedback_names[i])
+        hash = gpu_hash(
+            hash, feedback_names[i], (ptrdiff_t)SDL_strlen(feedback_names[i]) + 1);
+
+    SDL_snprintf(
+        filepath, sizeof(filepath), "%s%016llx.bin", gpu_pro_bin.dir,
+        (unsigned long long)hash);
+
+    uint32_t pro_id = gpu_pro_load(filepath);
+
+    if (pro_id)
+      return pro_id;
+  }
+
   uint32_t shader_id = glCreateShader(shader_type);
   glShaderSource(shader_id, 1, (const char **)&shader_string, NULL);
   glCompileShader(shader_id);
   uint32_t pro_id = glCreateProgram();
   glProgramParameteri(pro_id, 33368, 1);
+  if (filepath[0])
+    glProgramParameteri(pro_id, 33367, 1); // GL_PROGRAM_BINARY_RETRIEVABLE_HINT
   glAttachShader(pro_id, shader_id);
   if (feedback_count)
     glTransformFeedbackVaryings(pro_id, feedback_count, feedback_names, 35981);
   glLinkProgram(pro_id);
   glDetachShader(pro_id, shader_id);
   glDeleteShader(shader_id);
+
+  if (filepath[0])
+    gpu_pro_save(pro_id, filepath);
+
   return pro_id;
 }
 
@@ -540,6 +1238,10 @@ static inline uint32_t gpu_pro_file(
 #define gpu_frag_xfb(shader_string, feedback_count, feedback_names) gpu_pro(gpu_frag_t, shader_string, feedback_count, feedback_names)
 #define gpu_vert_xfb_file(shader_filepath, feedback_count, feedback_names) gpu_pro_file(gpu_vert_t, shader_filepath, feedback_count, feedback_names)
 #define gpu_frag_xfb_file(shader_filepath, feedback_count, feedback_names) gpu_pro_file(gpu_frag_t, shader_filepath, feedback_count, feedback_names)
+#define gpu_geom(shader_string) gpu_pro(gpu_geom_t, shader_string, 0, NULL)
+#define gpu_geom_file(shader_filepath) gpu_pro_file(gpu_geom_t, shader_filepath, 0, NULL)
+#define gpu_geom_xfb(shader_string, feedback_count, feedback_names) gpu_pro(gpu_geom_t, shader_string, feedback_count, feedback_names)
+#define gpu_geom_xfb_file(shader_filepath, feedback_count, feedback_names) gpu_pro_file(gpu_geom_t, shader_filepath, feedback_count, feedback_names)
 // clang-format on
 
 // clang-format off
@@ -578,6 +1280,19 @@ static inline uint32_t gpu_pro_file(
   "#extension GL_ARB_explicit_uniform_location : enable \n"                    \
   "layout(depth_less) out float gl_FragDepth;           \n"
 
+#define gpu_geom_head                                                          \
+  "#version 330                                         \n"                    \
+  "#extension GL_ARB_gpu_shader5               : enable \n"                    \
+  "#extension GL_ARB_gpu_shader_fp64           : enable \n"                    \
+  "#extension GL_ARB_shader_precision          : enable \n"                    \
+  "#extension GL_ARB_texture_cube_map_array    : enable \n"                    \
+  "#extension GL_ARB_separate_shader_objects   : enable \n"                    \
+  "#extension GL_ARB_shading_language_420pack  : enable \n"                    \
+  "#extension GL_ARB_shading_language_packing  : enable \n"                    \
+  "#extension GL_ARB_explicit_uniform_location : enable \n"                    \
+  "in gl_PerVertex { vec4 gl_Position; } gl_in[];       \n"                    \
+  "out gl_PerVertex { vec4 gl_Position; };              \n"
+
 static inline uint32_t gpu_ppo(uint32_t vert_pro_id, uint32_t frag_pro_id)
 {
   uint32_t ppo_id = 0;
@@ -635,23 +1350,27 @@ static inline uint32_t gpu_xfb(
   uint32_t xfb_id = 0;
   glCreateTransformFeedbacks(1, &xfb_id);
 
-  uint32_t mem_0_id = gpu_mem_ptr_0 ? ((uint32_t *)gpu_mem_ptr_0)[-1] : 0;
-  uint32_t mem_1_id = gpu_mem_ptr_1 ? ((uint32_t *)gpu_mem_ptr_1)[-1] : 0;
-  uint32_t mem_2_id = gpu_mem_ptr_2 ? ((uint32_t *)gpu_mem_ptr_2)[-1] : 0;
-  uint32_t mem_3_id = gpu_mem_ptr_3 ? ((uint32_t *)gpu_mem_ptr_3)[-1] : 0;
+  uint32_t mem_0_id = gpu_mem_ptr_0 ? gpu_mem_id(gpu_mem_ptr_0) : 0;
+  uint32_t mem_1_id = gpu_mem_ptr_1 ? gpu_mem_id(gpu_mem_ptr_1) : 0;
+  uint32_t mem_2_id = gpu_mem_ptr_2 ? gpu_mem_id(gpu_mem_ptr_2) : 0;
+  uint32_t mem_3_id = gpu_mem_ptr_3 ? gpu_mem_id(gpu_mem_ptr_3) : 0;
 
   if (mem_0_id)
     glTransformFeedbackBufferRange(
-        xfb_id, 0, mem_0_id, 4 + mem_0_bytes_first, mem_0_bytes_count);
+        xfb_id, 0, mem_0_id, gpu_mem_first(gpu_mem_ptr_0) + mem_0_bytes_first,
+        mem_0_bytes_count);
   if (mem_1_id)
     glTransformFeedbackBufferRange(
-        xfb_id, 1, mem_1_id, 4 + mem_1_bytes_first, mem_1_bytes_count);
+        xfb_id, 1, mem_1_id, gpu_mem_first(gpu_mem_ptr_1) + mem_1_bytes_first,
+        mem_1_bytes_count);
   if (mem_2_id)
     glTransformFeedbackBufferRange(
-        xfb_id, 2, mem_2_id, 4 + mem_2_bytes_first, mem_2_bytes_count);
+        xfb_id, 2, mem_2_id, gpu_mem_first(gpu_mem_ptr_2) + mem_2_bytes_first,
+        mem_2_bytes_count);
   if (mem_3_id)
     glTransformFeedbackBufferRange(
-        xfb_id, 3, mem_3_id, 4 + mem_3_bytes_first, mem_3_bytes_count);
+        xfb_id, 3, mem_3_id, gpu_mem_first(gpu_mem_ptr_3) + mem_3_bytes_first,
+        mem_3_bytes_count);
 
   return xfb_id;
 }
@@ -659,10 +1378,219 @@ static inline uint32_t gpu_xfb(
 #define gpu_bind_fbo(fbo_id) glBindFramebuffer(36160, fbo_id)
 #define gpu_bind_xfb(xfb_id) glBindTransformFeedback(36386, xfb_id)
 
+#ifndef GPU_PROF_SCOPES
+#define GPU_PROF_SCOPES 256
+#endif
+
+#define GPU_PROF_FRAMES 4
+#define GPU_PROF_DEPTH 32
+
+struct gpu_prof_scope_t
+{
+  const char * _Nullable name;
+  int32_t depth;
+  float ms;
+};
+
+static struct
+{
+  bool is_enabled;
+  int32_t frame;
+  int32_t stack_size;
+  int32_t stack[GPU_PROF_DEPTH];
+  int32_t count[GPU_PROF_FRAMES];
+  int32_t last[GPU_PROF_FRAMES];
+  uint32_t query[GPU_PROF_FRAMES][GPU_PROF_SCOPES * 2];
+  struct gpu_prof_scope_t scope[GPU_PROF_FRAMES][GPU_PROF_SCOPES];
+  uint64_t result_id;
+  int32_t result_count;
+  struct gpu_prof_scope_t result[GPU_PROF_SCOPES];
+} gpu_prof = {};
+
+static inline void gpu_prof_enable(bool is_enabled)
+{
+  if (is_enabled && gpu_prof.query[0][0] == 0)
+    glCreateQueries(
+        36392, GPU_PROF_FRAMES * GPU_PROF_SCOPES * 2, gpu_prof.query[0]);
+
+  gpu_prof.is_enabled = is_enabled;
+}
+
+static inline void gpu_prof_begin(const char * _Nonnull name)
+{
+  if (!gpu_prof.is_enabled)
+    return;
+
+  int32_t frame = gpu_prof.frame;
+  int32_t i = gpu_prof.count[frame];
+
+  if (gpu_prof.stack_size < GPU_PROF_DEPTH)
+  {
+    if (i < GPU_PROF_SCOPES)
+    {
+      gpu_prof.scope[frame][i].name = name;
+      gpu_prof.scope[frame][i].depth = gpu_prof.stack_size;
+      gpu_prof.scope[frame][i].ms = 0;
+      glQueryCounter(gpu_prof.query[frame][i * 2], 36392); // GL_TIMESTAMP
+      gpu_prof.last[frame] = i * 2;
+      gpu_prof.count[frame] = i + 1;
+    }
+    else
+    {
+      i = -1;
+    }
+    gpu_prof.stack[gpu_prof.stack_size] = i;
+  }
+
+  gpu_prof.stack_size += 1;
+}
+
+static inline void gpu_prof_end()
+{
+  if (gpu_prof.stack_size == 0)
+    return;
+
+  gpu_prof.stack_size -= 1;
+
+  if (gpu_prof.stack_size >= GPU_PROF_DEPTH)
+    return;
+
+  int32_t frame = gpu_prof.frame;
+  int32_t i = gpu_prof.stack[gpu_prof.stack_size];
+
+  if (i >= 0)
+  {
+    glQueryCounter(gpu_prof.query[frame][i * 2 + 1], 36392); // GL_TIMESTAMP
+    gpu_prof.last[frame] = i * 2 + 1;
+  }
+}
+
+// Closes the scopes of the current frame, then resolves the oldest frame,
+// recorded GPU_PROF_FRAMES - 1 frames ago, whose queries the next frame
+// reuses. It's dropped if its last timestamp isn't available yet, so
+// reading results never stalls.
+static inline void gpu_prof_frame()
+{
+  if (gpu_prof.query[0][0] == 0)
+    return;
+
+  while (gpu_prof.stack_size > 0)
+    gpu_prof_end();
+
+  int32_t frame = (gpu_prof.frame + 1) % GPU_PROF_FRAMES;
+  int32_t count = gpu_prof.count[frame];
+  uint32_t * query = gpu_prof.query[frame];
+
+  if (count > 0)
+  {
+    int32_t is_available = 0;
+    // GL_QUERY_RESULT_AVAILABLE
+    glGetQueryObjectiv(query[gpu_prof.last[frame]], 34919, &is_available);
+
+    if (is_available)
+    {
+      for (int32_t i = 0; i < count; ++i)
+      {
+        uint64_t begin = 0, end = 0;
+        glGetQueryObjectui64v(query[i * 2], 34918, &begin); // GL_QUERY_RESULT
+        glGetQueryObjectui64v(query[i * 2 + 1], 34918, &end);
+        gpu_prof.result[i] = gpu_prof.scope[frame][i];
+        gpu_prof.result[i].ms = end > begin ? (float)(end - begin) / 1e6f : 0;
+      }
+      gpu_prof.result_count = count;
+      gpu_prof.result_id += 1;
+    }
+  }
+
+  gpu_prof.frame = frame;
+  gpu_prof.count[frame] = 0;
+}
+
+static inline int32_t gpu_prof_results(
+    const struct gpu_prof_scope_t * _Nullable * _Nonnull scopes)
+{
+  *scopes = gpu_prof.result;
+  return gpu_prof.result_count;
+}
+
+#ifndef GPU_MDI_BYTES
+#define GPU_MDI_BYTES (1024 * 1024)
+#endif
+
+#define GPU_MDI_SEGMENTS 4
+
+static struct
+{
+  int32_t state;
+  uint32_t mem_id;
+  struct gpu_cmd_t * _Nullable cmd;
+  int32_t segment;
+  int32_t segment_used;
+  void * _Nullable fence[GPU_MDI_SEGMENTS];
+} gpu_mdi = {};
+
+static inline void gpu_submit(
+    uint32_t mode, int32_t cmd_count, const struct gpu_cmd_t * _Nonnull cmd)
+{
+  int32_t segment_size = (int32_t)(
+      GPU_MDI_BYTES / GPU_MDI_SEGMENTS / (ptrdiff_t)sizeof(struct gpu_cmd_t));
+
+  // state: 0 not checked yet, 1 indirect buffer ready, -1 unsupported
+  if (gpu_mdi.state == 0)
+  {
+    gpu_mdi.state = -1;
+
+    if (glMultiDrawArraysIndirect && glBindBuffer &&
+        gpu_has_ext("GL_ARB_multi_draw_indirect"))
+    {
+      glCreateBuffers(1, &gpu_mdi.mem_id);
+      glNamedBufferStorage(gpu_mdi.mem_id, GPU_MDI_BYTES, NULL, 194);
+      gpu_mdi.cmd =
+          glMapNamedBufferRange(gpu_mdi.mem_id, 0, GPU_MDI_BYTES, 194);
+
+      if (gpu_mdi.cmd)
+      {
+        glBindBuffer(36671, gpu_mdi.mem_id); // GL_DRAW_INDIRECT_BUFFER
+        gpu_mdi.state = 1;
+      }
+    }
+  }
+
+  if (gpu_mdi.state != 1 || cmd_count < 2 || cmd_count > segment_size)
+  {
+    for (ptrdiff_t i = 0; i < cmd_count; ++i)
+      glDrawArraysInstancedBaseInstance(
+          mode, cmd[i].first, cmd[i].count, cmd[i].instance_count,
+          cmd[i].instance_first);
+    return;
+  }
+
+  if (gpu_mdi.segment_used + cmd_count > segment_size)
+  {
+    gpu_mdi.fence[gpu_mdi.segment] = gpu_fence();
+    gpu_mdi.segment = (gpu_mdi.segment + 1) % GPU_MDI_SEGMENTS;
+    gpu_mdi.segment_used = 0;
+    gpu_wait(gpu_mdi.fence[gpu_mdi.segment]);
+    gpu_mdi.fence[gpu_mdi.segment] = NULL;
+  }
+
+  ptrdiff_t first = gpu_mdi.segment * segment_size + gpu_mdi.segment_used;
+
+  SDL_memcpy(
+      gpu_mdi.cmd + first, cmd,
+      (size_t)cmd_count * sizeof(struct gpu_cmd_t));
+
+  glMultiDrawArraysIndirect(
+      mode, (const void *)(first * (ptrdiff_t)sizeof(struct gpu_cmd_t)),
+      cmd_count, 0);
+
+  gpu_mdi.segment_used += cmd_count;
+}
+
 static inline void
 gpu_draw(int32_t gpu_ops_count, const struct gpu_ops_t * _Nonnull gpu_ops)
 {
-  __auto_type submit = glDrawArraysInstancedBaseInstance;
+  gpu_prof_begin("gpu_draw");
 
   int32_t prev_id = 0;
   int32_t prev_tex_first = 0;
@@ -701,13 +1629,7 @@ gpu_draw(int32_t gpu_ops_count, const struct gpu_ops_t * _Nonnull gpu_ops)
     if (ops.ppo != 0 && ops.ppo != prev_ppo)
       glBindProgramPipeline(ops.ppo);
 
-    for (ptrdiff_t i = 0; i < ops.cmd_count; ++i)
-    {
-      struct gpu_cmd_t cmd = ops.cmd[i];
-      submit(
-          ops.mode, cmd.first, cmd.count, cmd.instance_count,
-          cmd.instance_first);
-    }
+    gpu_submit(ops.mode, ops.cmd_count, ops.cmd);
 
     prev_id = ops.id;
     prev_tex_first = ops.tex_first;
@@ -720,12 +1642,128 @@ gpu_draw(int32_t gpu_ops_count, const struct gpu_ops_t * _Nonnull gpu_ops)
     prev_frag = ops.frag;
     prev_ppo = ops.ppo;
   }
+
+  gpu_prof_end();
+}
+
+static inline void gpu_radix64(
+    ptrdiff_t count, uint64_t * _Nonnull keys, int32_t * _Nonnull index,
+    uint64_t * _Nonnull keys_tmp, int32_t * _Nonnull index_tmp)
+{
+  uint64_t * src_keys = keys;
+  uint64_t * dst_keys = keys_tmp;
+  int32_t * src_index = index;
+  int32_t * dst_index = index_tmp;
+
+  for (int32_t shift = 0; shift < 64 && count > 1; shift += 8)
+  {
+    ptrdiff_t offset[256] = {};
+
+    for (ptrdiff_t i = 0; i < count; ++i)
+      offset[(src_keys[i] >> shift) & 255] += 1;
+
+    if (offset[(src_keys[0] >> shift) & 255] == count)
+      continue;
+
+    for (ptrdiff_t i = 0, sum = 0; i < 256; ++i)
+    {
+      ptrdiff_t digit_count = offset[i];
+      offset[i] = sum;
+      sum += digit_count;
+    }
+
+    for (ptrdiff_t i = 0; i < count; ++i)
+    {
+      ptrdiff_t j = offset[(src_keys[i] >> shift) & 255]++;
+      dst_keys[j] = src_keys[i];
+      dst_index[j] = src_index[i];
+    }
+
+    uint64_t * swap_keys = src_keys;
+    int32_t * swap_index = src_index;
+    src_keys = dst_keys, dst_keys = swap_keys;
+    src_index = dst_index, dst_index = swap_index;
+  }
+
+  if (src_keys != keys)
+  {
+    SDL_memcpy(keys, src_keys, (size_t)count * sizeof(uint64_t));
+    SDL_memcpy(index, src_index, (size_t)count * sizeof(int32_t));
+  }
+}
+
+static inline uint64_t
+gpu_draw_key(const struct gpu_ops_t * _Nonnull ops, uint16_t depth)
+{
+  uint64_t tex = ((uint64_t)(uintptr_t)ops->tex ^
+                  (uint64_t)(uint32_t)ops->tex_first << 48 ^
+                  (uint64_t)(uint32_t)ops->tex_count << 56) *
+                 0x9E3779B97F4A7C15ull;
+  uint64_t smp = ((uint64_t)(uintptr_t)ops->smp ^
+                  (uint64_t)(uint32_t)ops->smp_first << 48 ^
+                  (uint64_t)(uint32_t)ops->smp_count << 56) *
+                 0x9E3779B97F4A7C15ull;
+
+  // ppo:16 | tex set:16 | smp set:12 | mode:4 | depth:16
+  return (uint64_t)(ops->ppo & 0xFFFF) << 48 | (tex >> 48) << 32 |
+         (smp >> 52) << 20 | (uint64_t)(ops->mode & 0xF) << 16 | depth;
+}
+
+static struct
+{
+  ptrdiff_t capacity;
+  uint64_t * _Nullable keys;
+  int32_t * _Nullable index;
+  struct gpu_ops_t * _Nullable ops;
+} gpu_draw_keys = {};
+
+static inline void gpu_draw_sorted(
+    int32_t gpu_ops_count, const struct gpu_ops_t * _Nonnull gpu_ops,
+    const uint16_t * _Nullable depth)
+{
+  if (gpu_ops_count > gpu_draw_keys.capacity)
+  {
+    ptrdiff_t capacity = gpu_ops_count;
+    SDL_free(gpu_draw_keys.keys);
+    SDL_free(gpu_draw_keys.index);
+    SDL_free(gpu_draw_keys.ops);
+    gpu_draw_keys.keys = SDL_malloc((size_t)capacity * 2 * sizeof(uint64_t));
+    gpu_draw_keys.index = SDL_malloc((size_t)capacity * 2 * sizeof(int32_t));
+    gpu_draw_keys.ops =
+        SDL_malloc((size_t)capacity * sizeof(struct gpu_ops_t));
+    gpu_draw_keys.capacity = capacity;
+
+    if (!gpu_draw_keys.keys || !gpu_draw_keys.index || !gpu_draw_keys.ops)
+    {
+      gpu_draw_keys.capacity = 0;
+      gpu_draw(gpu_ops_count, gpu_ops);
+      return;
+    }
+  }
+
+  uint64_t * keys = gpu_draw_keys.keys;
+  int32_t * index = gpu_draw_keys.index;
+  struct gpu_ops_t * ops = gpu_draw_keys.ops;
+
+  for (int32_t i = 0; i < gpu_ops_count; ++i)
+  {
+    keys[i] = gpu_draw_key(&gpu_ops[i], depth ? depth[i] : 0);
+    index[i] = i;
+  }
+
+  gpu_radix64(
+      gpu_ops_count, keys, index, keys + gpu_ops_count, index + gpu_ops_count);
+
+  for (int32_t i = 0; i < gpu_ops_count; ++i)
+    ops[i] = gpu_ops[index[i]];
+
+  gpu_draw(gpu_ops_count, ops);
 }
 
 static inline void
 gpu_draw_xfb(int32_t gpu_ops_count, const struct gpu_ops_t * _Nonnull gpu_ops)
 {
-  __auto_type submit = glDrawArraysInstancedBaseInstance;
+  gpu_prof_begin("gpu_draw_xfb");
 
   int32_t prev_id = 0;
   int32_t prev_tex_first = 0;
@@ -765,13 +1803,7 @@ gpu_draw_xfb(int32_t gpu_ops_count, const struct gpu_ops_t * _Nonnull gpu_ops)
       glBindProgramPipeline(ops.ppo);
 
     glBeginTransformFeedback(ops.mode);
-    for (ptrdiff_t i = 0; i < ops.cmd_count; ++i)
-    {
-      struct gpu_cmd_t cmd = ops.cmd[i];
-      submit(
-          ops.mode, cmd.first, cmd.count, cmd.instance_count,
-          cmd.instance_first);
-    }
+    gpu_submit(ops.mode, ops.cmd_count, ops.cmd);
     glEndTransformFeedback();
 
     prev_id = ops.id;
@@ -785,6 +1817,8 @@ gpu_draw_xfb(int32_t gpu_ops_count, const struct gpu_ops_t * _Nonnull gpu_ops)
     prev_frag = ops.frag;
     prev_ppo = ops.ppo;
   }
+
+  gpu_prof_end();
 }
 
 static inline void gpu_blit(
@@ -793,6 +1827,8 @@ static inline void gpu_blit(
     uint32_t target_fbo_id, int32_t target_color_id, int32_t target_x,
     int32_t target_y, int32_t target_width, int32_t target_height)
 {
+  gpu_prof_begin("gpu_blit");
+
   glNamedFramebufferReadBuffer(source_fbo_id, 36064 + source_color_id);
   glNamedFramebufferDrawBuffer(target_fbo_id, 36064 + target_color_id);
 
@@ -800,21 +1836,118 @@ static inline void gpu_blit(
       source_fbo_id, target_fbo_id, source_x, source_y, source_width,
       source_height, target_x, target_y, target_width, target_height, 16384,
       9728);
+
+  gpu_prof_end();
 }
 
 static inline void gpu_blit_to_screen(
     uint32_t fbo_id, int32_t color_id, int32_t width, int32_t height)
 {
+  gpu_prof_begin("gpu_blit_to_screen");
+
   glNamedFramebufferReadBuffer(fbo_id, 36064 + color_id);
   glNamedFramebufferDrawBuffer(0, 1029);
 
   glBlitNamedFramebuffer(
       fbo_id, 0, 0, 0, width, height, 0, 0, width, height, 16384, 9728);
+
+  gpu_prof_end();
 }
 
-#define gpu_clear() glClear(16640)
-#define gpu_swap(sdl_window)                                                   \
-  {                                                                            \
-    SDL_GL_SwapWindow(sdl_window);                                             \
-    glFinish();                                                                \
+#ifndef GPU_FRAMES_MAX
+#define GPU_FRAMES_MAX 8
+#endif
+
+static struct
+{
+  int32_t frames_in_flight;
+  uint64_t frame;
+  uint64_t frame_done;
+  void * _Nullable fence[GPU_FRAMES_MAX];
+} gpu_frames = {};
+
+static inline void gpu_frames_retire(uint64_t frame)
+{
+  for (uint64_t i = gpu_frames.frame_done; i <= frame; ++i)
+  {
+    void * fence = gpu_frames.fence[i % GPU_FRAMES_MAX];
+    if (fence)
+      glDeleteSync(fence);
+    gpu_frames.fence[i % GPU_FRAMES_MAX] = NULL;
   }
+
+  gpu_frames.frame_done = frame + 1;
+}
+
+static inline void gpu_frames_in_flight(int32_t frames_in_flight)
+{
+  if (frames_in_flight < 0)
+    frames_in_flight = 0;
+  if (frames_in_flight > GPU_FRAMES_MAX - 1)
+    frames_in_flight = GPU_FRAMES_MAX - 1;
+
+  gpu_frames.frames_in_flight = frames_in_flight;
+}
+
+static inline uint64_t gpu_frame() { return gpu_frames.frame; }
+
+static inline bool gpu_frame_done(uint64_t frame)
+{
+  if (frame < gpu_frames.frame_done)
+    return true;
+
+  if (frame >= gpu_frames.frame)
+    return false;
+
+  void * fence = gpu_frames.fence[frame % GPU_FRAMES_MAX];
+  uint32_t status = fence ? glClientWaitSync(fence, 0, 0) : 37146;
+
+  // GL_ALREADY_SIGNALED, GL_CONDITION_SATISFIED
+  if (status != 37146 && status != 37148)
+    return false;
+
+  gpu_frames_retire(frame);
+
+  return true;
+}
+
+static inline void gpu_frame_wait(uint64_t frame)
+{
+  if (frame < gpu_frames.frame_done || frame >= gpu_frames.frame)
+    return;
+
+  void * fence = gpu_frames.fence[frame % GPU_FRAMES_MAX];
+
+  // GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_EXPIRED
+  while (fence && glClientWaitSync(fence, 1, 1000000) == 37147)
+    ;
+
+  gpu_frames_retire(frame);
+}
+
+static inline void gpu_swap(SDL_Window * _Nonnull sdl_window)
+{
+  gpu_prof_frame();
+#ifdef GPU_TRACE
+  gpu_trace_frame();
+#endif
+
+  SDL_GL_SwapWindow(sdl_window);
+
+  uint64_t frame = gpu_frames.frame;
+  gpu_frames.frame = frame + 1;
+
+  if (gpu_frames.frames_in_flight == 0)
+  {
+    glFinish();
+    gpu_frames_retire(frame);
+    return;
+  }
+
+  gpu_frames.fence[frame % GPU_FRAMES_MAX] = gpu_fence();
+
+  if (frame >= (uint64_t)gpu_frames.frames_in_flight)
+    gpu_frame_wait(frame - (uint64_t)gpu_frames.frames_in_flight);
+}
+
+#define gpu_clear() glClear(16640)
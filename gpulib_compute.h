@@ -0,0 +1,1201 @@
+#pragma once
+#include "gpulib.h"
+
+// Data-parallel primitives over gpu_malloc arrays. Inputs are read through
+// gpu_cast views, outputs are written by transform feedback or into render
+// targets, nothing round-trips through the CPU until the caller reads the
+// result. Functions return a fence to gpu_wait on before reading.
+
+#ifndef GPU_MAP_INPUTS
+#define GPU_MAP_INPUTS 8
+#endif
+
+#ifndef GPU_COMPUTE_CACHE
+#define GPU_COMPUTE_CACHE 64
+#endif
+
+#ifndef GPU_MAP_SOURCE_BYTES
+#define GPU_MAP_SOURCE_BYTES 16384
+#endif
+
+struct gpu_map_in_t
+{
+  void * _Nullable mem;
+  enum gpu_tex_mem_format_t format;
+  ptrdiff_t bytes_first;
+};
+
+// kind: 0 float, 1 int, 2 uint
+struct gpu_compute_type_t
+{
+  int32_t components;
+  int32_t bytes;
+  int32_t kind;
+};
+
+static const char * _Nonnull const gpu_compute_glsl[3][5] = {
+    {"", "float", "vec2", "vec3", "vec4"},
+    {"", "int", "ivec2", "ivec3", "ivec4"},
+    {"", "uint", "uvec2", "uvec3", "uvec4"},
+};
+
+static const char * _Nonnull const gpu_compute_sampler[3] = {"", "i", "u"};
+
+static const char * _Nonnull const gpu_compute_swizzle[5] = {
+    "", "x", "xy", "xyz", "xyzw"};
+
+static struct
+{
+  uint32_t fbo;
+  uint32_t fbo_tex;
+  uint32_t smp;
+  int32_t prev_fbo;
+  int32_t prev_viewport[4];
+  int32_t prev_blend;
+  int32_t prev_scissor;
+} gpu_compute = {};
+
+// ppo is 0 on GLSL errors
+struct gpu_compute_pro_t
+{
+  uint32_t vert;
+  uint32_t geom;
+  uint32_t frag;
+  uint32_t ppo;
+};
+
+// Primitives bump call before looking up their programs, entries used since
+// are never evicted, so handles stay valid until the primitive returns
+static struct
+{
+  int32_t count;
+  int32_t next;
+  uint32_t call;
+  uint64_t hash[GPU_COMPUTE_CACHE];
+  uint32_t used[GPU_COMPUTE_CACHE];
+  struct gpu_compute_pro_t pro[GPU_COMPUTE_CACHE];
+} gpu_compute_cache = {};
+
+static inline struct gpu_compute_type_t
+gpu_compute_type(enum gpu_tex_mem_format_t format)
+{
+  struct gpu_compute_type_t type = {};
+
+  // clang-format off
+  switch (format)
+  {
+    case gpu_x_b8_t:     type = (struct gpu_compute_type_t){1, 1, 0}; break;
+    case gpu_x_f16_t:    type = (struct gpu_compute_type_t){1, 2, 0}; break;
+    case gpu_x_f32_t:    type = (struct gpu_compute_type_t){1, 4, 0}; break;
+    case gpu_x_i8_t:     type = (struct gpu_compute_type_t){1, 1, 1}; break;
+    case gpu_x_i16_t:    type = (struct gpu_compute_type_t){1, 2, 1}; break;
+    case gpu_x_i32_t:    type = (struct gpu_compute_type_t){1, 4, 1}; break;
+    case gpu_x_u8_t:     type = (struct gpu_compute_type_t){1, 1, 2}; break;
+    case gpu_x_u16_t:    type = (struct gpu_compute_type_t){1, 2, 2}; break;
+    case gpu_x_u32_t:    type = (struct gpu_compute_type_t){1, 4, 2}; break;
+    case gpu_xy_b8_t:    type = (struct gpu_compute_type_t){2, 1, 0}; break;
+    case gpu_xy_f16_t:   type = (struct gpu_compute_type_t){2, 2, 0}; break;
+    case gpu_xy_f32_t:   type = (struct gpu_compute_type_t){2, 4, 0}; break;
+    case gpu_xy_i8_t:    type = (struct gpu_compute_type_t){2, 1, 1}; break;
+    case gpu_xy_i16_t:   type = (struct gpu_compute_type_t){2, 2, 1}; break;
+    case gpu_xy_i32_t:   type = (struct gpu_compute_type_t){2, 4, 1}; break;
+    case gpu_xy_u8_t:    type = (struct gpu_compute_type_t){2, 1, 2}; break;
+    case gpu_xy_u16_t:   type = (struct gpu_compute_type_t){2, 2, 2}; break;
+    case gpu_xy_u32_t:   type = (struct gpu_compute_type_t){2, 4, 2}; break;
+    case gpu_xyz_f32_t:  type = (struct gpu_compute_type_t){3, 4, 0}; break;
+    case gpu_xyz_i32_t:  type = (struct gpu_compute_type_t){3, 4, 1}; break;
+    case gpu_xyz_u32_t:  type = (struct gpu_compute_type_t){3, 4, 2}; break;
+    case gpu_xyzw_b8_t:  type = (struct gpu_compute_type_t){4, 1, 0}; break;
+    case gpu_xyzw_f16_t: type = (struct gpu_compute_type_t){4, 2, 0}; break;
+    case gpu_xyzw_f32_t: type = (struct gpu_compute_type_t){4, 4, 0}; break;
+    case gpu_xyzw_i8_t:  type = (struct gpu_compute_type_t){4, 1, 1}; break;
+    case gpu_xyzw_i16_t: type = (struct gpu_compute_type_t){4, 2, 1}; break;
+    case gpu_xyzw_i32_t: type = (struct gpu_compute_type_t){4, 4, 1}; break;
+    case gpu_xyzw_u8_t:  type = (struct gpu_compute_type_t){4, 1, 2}; break;
+    case gpu_xyzw_u16_t: type = (struct gpu_compute_type_t){4, 2, 2}; break;
+    case gpu_xyzw_u32_t: type = (struct gpu_compute_type_t){4, 4, 2}; break;
+    default: break;
+  }
+  // clang-format on
+
+  return type;
+}
+
+// Saves the state compute passes change: the draw framebuffer, viewport,
+// blending and scissor test.
+static inline void gpu_compute_begin()
+{
+  glGetIntegerv(36006, &gpu_compute.prev_fbo); // GL_DRAW_FRAMEBUFFER_BINDING
+  glGetIntegerv(2978, gpu_compute.prev_viewport); // GL_VIEWPORT
+  glGetIntegerv(3042, &gpu_compute.prev_blend);   // GL_BLEND
+  glGetIntegerv(3089, &gpu_compute.prev_scissor); // GL_SCISSOR_TEST
+
+  glDisable(3042); // GL_BLEND
+  glDisable(3089); // GL_SCISSOR_TEST
+}
+
+static inline void gpu_compute_end()
+{
+  // GL_DRAW_FRAMEBUFFER
+  glBindFramebuffer(36009, (uint32_t)gpu_compute.prev_fbo);
+  glViewport(
+      gpu_compute.prev_viewport[0], gpu_compute.prev_viewport[1],
+      gpu_compute.prev_viewport[2], gpu_compute.prev_viewport[3]);
+
+  if (gpu_compute.prev_blend)
+    glEnable(3042); // GL_BLEND
+  if (gpu_compute.prev_scissor)
+    glEnable(3089); // GL_SCISSOR_TEST
+}
+
+// Transform feedback draws still need a complete framebuffer even with
+// rasterization discarded, and headless contexts have none by default.
+static inline void gpu_compute_bind_discard()
+{
+  if (gpu_compute.fbo == 0)
+  {
+    gpu_compute.fbo_tex = gpu_malloc_img(gpu_r_b8_t, 1, 1, 1, 1);
+    gpu_compute.fbo = gpu_fbo(gpu_compute.fbo_tex, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+  }
+
+  glBindFramebuffer(36009, gpu_compute.fbo); // GL_DRAW_FRAMEBUFFER
+}
+
+// Integer textures sampled with linear filters are incomplete
+static inline uint32_t gpu_compute_smp()
+{
+  if (gpu_compute.smp == 0)
+    gpu_compute.smp =
+        gpu_smp(1, gpu_nearest_t, gpu_nearest_t, gpu_clamp_to_edge_t);
+
+  return gpu_compute.smp;
+}
+
+// Returns the programs and pipeline built from the given stages, cached and
+// kept alive until the next primitive call. Without frag_string the last of
+// vert_string and geom_string is a transform feedback program writing "o".
+static inline struct gpu_compute_pro_t gpu_compute_ppo(
+    const char * _Nonnull vert_string, const char * _Nullable geom_string,
+    const char * _Nullable frag_string)
+{
+  uint64_t hash = gpu_hash(
+      14695981039346656037ull, vert_string,
+      (ptrdiff_t)SDL_strlen(vert_string) + 1);
+  if (geom_string)
+    hash = gpu_hash(hash, geom_string, (ptrdiff_t)SDL_strlen(geom_string) + 1);
+  if (frag_string)
+    hash = gpu_hash(hash, frag_string, (ptrdiff_t)SDL_strlen(frag_string));
+
+  int32_t cached = gpu_compute_cache.count < GPU_COMPUTE_CACHE
+                       ? gpu_compute_cache.count
+                       : GPU_COMPUTE_CACHE;
+
+  for (int32_t i = 0; i < cached; ++i)
+  {
+    if (gpu_compute_cache.hash[i] == hash)
+    {
+      gpu_compute_cache.used[i] = gpu_compute_cache.call;
+      return gpu_compute_cache.pro[i];
+    }
+  }
+
+  const char * _Nullable o[] = {"o"};
+  bool is_vert_xfb = geom_string == NULL && frag_string == NULL;
+  bool is_geom_xfb = geom_string != NULL && frag_string == NULL;
+
+  uint32_t pro[3] = {
+      gpu_pro(gpu_vert_t, vert_string, is_vert_xfb ? 1 : 0, o),
+      geom_string ? gpu_pro(gpu_geom_t, geom_string, is_geom_xfb ? 1 : 0, o)
+                  : 0,
+      frag_string ? gpu_frag(frag_string) : 0,
+  };
+
+  bool is_linked = true;
+
+  for (int32_t k = 0; k < 3; ++k)
+  {
+    int32_t link_status = 1;
+    if (pro[k])
+      glGetProgramiv(pro[k], 35714, &link_status); // GL_LINK_STATUS
+    is_linked = is_linked && link_status;
+  }
+
+  if (!is_linked)
+  {
+    for (int32_t k = 0; k < 3; ++k)
+      if (pro[k])
+        glDeleteProgram(pro[k]);
+    return (struct gpu_compute_pro_t){};
+  }
+
+  int32_t i = gpu_compute_cache.count;
+
+  // Evict round-robin once full, skipping entries of the current call
+  if (gpu_compute_cache.count >= GPU_COMPUTE_CACHE)
+  {
+    i = gpu_compute_cache.next;
+
+    for (int32_t k = 0; k < GPU_COMPUTE_CACHE; ++k)
+    {
+      if (gpu_compute_cache.used[i] != gpu_compute_cache.call)
+        break;
+      i = (i + 1) % GPU_COMPUTE_CACHE;
+    }
+
+    gpu_compute_cache.next = (i + 1) % GPU_COMPUTE_CACHE;
+
+    struct gpu_compute_pro_t evicted = gpu_compute_cache.pro[i];
+    glDeleteProgramPipelines(1, &evicted.ppo);
+    glDeleteProgram(evicted.vert);
+    if (evicted.geom)
+      glDeleteProgram(evicted.geom);
+    if (evicted.frag)
+      glDeleteProgram(evicted.frag);
+  }
+  else
+    gpu_compute_cache.count += 1;
+
+  struct gpu_compute_pro_t result = {pro[0], pro[1], pro[2], 0};
+  result.ppo = gpu_ppo(pro[0], pro[2]);
+
+  if (pro[1])
+    glUseProgramStages(result.ppo, 4, pro[1]); // GL_GEOMETRY_SHADER_BIT
+
+  gpu_compute_cache.hash[i] = hash;
+  gpu_compute_cache.used[i] = gpu_compute_cache.call;
+  gpu_compute_cache.pro[i] = result;
+
+  return result;
+}
+
+// Writes o[i] = expr for i in [0, count) to out_mem + out_bytes_first.
+// expr sees the element index as i and element i of input k as ik, typed
+// after its format, e.g. "i0 * 2.0 + i1". out_format must have 32 bit
+// components. Input views start at bytes_first, which must meet
+// GL_TEXTURE_BUFFER_OFFSET_ALIGNMENT. Returns a fence, NULL on bad
+// arguments or a GLSL error.
+static inline void * _Nullable gpu_map(
+    const char * _Nonnull expr, int32_t count, void * _Nonnull out_mem,
+    enum gpu_tex_mem_format_t out_format, ptrdiff_t out_bytes_first,
+    int32_t in_count, const struct gpu_map_in_t * _Nullable in)
+{
+  struct gpu_compute_type_t out_type = gpu_compute_type(out_format);
+
+  if (count <= 0 || out_type.bytes != 4 || in_count < 0 ||
+      in_count > GPU_MAP_INPUTS || (in_count > 0 && in == NULL))
+    return NULL;
+
+  char vert_string[GPU_MAP_SOURCE_BYTES] = {};
+  ptrdiff_t n = 0;
+
+  n += SDL_snprintf(
+      vert_string + n, sizeof(vert_string) - (size_t)n, "%s out %s o;\n",
+      gpu_vert_head, gpu_compute_glsl[out_type.kind][out_type.components]);
+
+  for (int32_t k = 0; k < in_count && n < GPU_MAP_SOURCE_BYTES; ++k)
+  {
+    struct gpu_compute_type_t type = gpu_compute_type(in[k].format);
+
+    if (type.bytes == 0 || in[k].mem == NULL)
+      return NULL;
+
+    n += SDL_snprintf(
+        vert_string + n, sizeof(vert_string) - (size_t)n,
+        " layout(binding = %d) uniform %ssamplerBuffer s_i%d;\n", k,
+        gpu_compute_sampler[type.kind], k);
+  }
+
+  if (n < GPU_MAP_SOURCE_BYTES)
+    n += SDL_snprintf(
+        vert_string + n, sizeof(vert_string) - (size_t)n,
+        " void main()\n {\n   int i = gl_VertexID;\n");
+
+  for (int32_t k = 0; k < in_count && n < GPU_MAP_SOURCE_BYTES; ++k)
+  {
+    struct gpu_compute_type_t type = gpu_compute_type(in[k].format);
+
+    n += SDL_snprintf(
+        vert_string + n, sizeof(vert_string) - (size_t)n,
+        "   %s i%d = texelFetch(s_i%d, i).%s;\n",
+        gpu_compute_glsl[type.kind][type.components], k, k,
+        gpu_compute_swizzle[type.components]);
+  }
+
+  if (n < GPU_MAP_SOURCE_BYTES)
+    n += SDL_snprintf(
+        vert_string + n, sizeof(vert_string) - (size_t)n,
+        "   o = %s(%s);\n }\n",
+        gpu_compute_glsl[out_type.kind][out_type.components], expr);
+
+  if (n >= GPU_MAP_SOURCE_BYTES)
+    return NULL;
+
+  gpu_compute_cache.call += 1;
+
+  struct gpu_compute_pro_t pro = gpu_compute_ppo(vert_string, NULL, NULL);
+
+  if (pro.ppo == 0)
+    return NULL;
+
+  uint32_t tex[GPU_MAP_INPUTS] = {};
+
+  for (int32_t k = 0; k < in_count; ++k)
+  {
+    struct gpu_compute_type_t type = gpu_compute_type(in[k].format);
+    tex[k] = gpu_cast(
+        in[k].mem, in[k].format, in[k].bytes_first,
+        (ptrdiff_t)count * type.components * type.bytes);
+  }
+
+  uint32_t xfb = gpu_xfb(
+      out_mem, out_bytes_first, (ptrdiff_t)count * out_type.components * 4,
+      NULL, 0, 0, NULL, 0, 0, NULL, 0, 0);
+
+  struct gpu_cmd_t cmd = {};
+  cmd.count = count;
+  cmd.instance_count = 1;
+
+  struct gpu_ops_t ops = {};
+  ops.tex_count = in_count;
+  ops.tex = in_count ? tex : NULL;
+  ops.ppo = pro.ppo;
+  ops.mode = gpu_points_t;
+  ops.cmd_count = 1;
+  ops.cmd = &cmd;
+
+  gpu_compute_begin();
+  gpu_compute_bind_discard();
+  glEnable(35977); // GL_RASTERIZER_DISCARD
+  gpu_bind_xfb(xfb);
+  gpu_draw_xfb(1, &ops);
+  gpu_bind_xfb(0);
+  glDisable(35977); // GL_RASTERIZER_DISCARD
+  gpu_compute_end();
+
+  glDeleteTransformFeedbacks(1, &xfb);
+  if (in_count)
+    glDeleteTextures(in_count, tex);
+
+  return gpu_fence();
+}
+
+#ifndef GPU_REDUCE_GROUP
+#define GPU_REDUCE_GROUP 16
+#endif
+
+#define GPU_REDUCE_WIDTH 1024
+
+enum gpu_reduce_t
+{
+  gpu_sum_t,
+  gpu_min_t,
+  gpu_max_t,
+  gpu_argmin_t,
+  gpu_argmax_t,
+  gpu_mean_t
+};
+
+#define gpu_reduce_head                                                        \
+  gpu_frag_head " layout(location = 0) uniform int id;                    \n"
+
+static inline const char * _Nonnull
+gpu_reduce_identity(enum gpu_reduce_t op, int32_t kind)
+{
+  switch (op)
+  {
+  case gpu_min_t:
+  case gpu_argmin_t:
+    return kind == 0   ? "uintBitsToFloat(0x7F800000u)"
+           : kind == 1 ? "0x7FFFFFFF"
+                       : "0xFFFFFFFFu";
+  case gpu_max_t:
+  case gpu_argmax_t:
+    return kind == 0   ? "uintBitsToFloat(0xFF800000u)"
+           : kind == 1 ? "(-0x7FFFFFFF - 1)"
+                       : "0u";
+  case gpu_sum_t:
+  case gpu_mean_t:
+  default:
+    return kind == 0 ? "0.0" : kind == 1 ? "0" : "0u";
+  }
+}
+
+// Folds value with index i into v and index
+static inline const char * _Nonnull gpu_reduce_update(enum gpu_reduce_t op)
+{
+  switch (op)
+  {
+  case gpu_min_t:
+    return "v = min(v, value);";
+  case gpu_max_t:
+    return "v = max(v, value);";
+  case gpu_argmin_t:
+    return "if (index == 0xFFFFFFFFu || value < v) { v = value; index = i; }";
+  case gpu_argmax_t:
+    return "if (index == 0xFFFFFFFFu || value > v) { v = value; index = i; }";
+  case gpu_sum_t:
+  case gpu_mean_t:
+  default:
+    return "v += value;";
+  }
+}
+
+static inline struct gpu_compute_pro_t
+gpu_reduce_ppo(enum gpu_reduce_t op, int32_t kind, bool is_first)
+{
+  bool is_arg = op == gpu_argmin_t || op == gpu_argmax_t;
+
+  // Partials per output texel: 4 values, or 2 value and index pairs
+  int32_t packed = is_arg ? 2 : 4;
+
+  // Means are sums of floats, int and uint inputs convert on load
+  int32_t acc_kind = op == gpu_mean_t ? 0 : kind;
+  const char * acc = gpu_compute_glsl[acc_kind][1];
+
+  const char * identity = gpu_reduce_identity(op, acc_kind);
+  const char * update = gpu_reduce_update(op);
+
+  // Arg partials are stored as uint bits, so float values survive exactly
+  const char * out_type = is_arg ? "uvec4" : gpu_compute_glsl[acc_kind][4];
+  const char * encode = acc_kind == 0 ? "floatBitsToUint" : "uint";
+  const char * decode = acc_kind == 0   ? "uintBitsToFloat"
+                        : acc_kind == 1 ? "int"
+                                        : "uint";
+
+  char load[1024] = {};
+
+  if (is_first)
+  {
+    SDL_snprintf(
+        load, sizeof(load),
+        " layout(binding = 0) uniform %ssamplerBuffer s_in;               \n"
+        "                                                                 \n"
+        " %s load(int p, out uint index)                                  \n"
+        " {                                                               \n"
+        "   index = uint(p);                                              \n"
+        "   return %s(texelFetch(s_in, p).x);                             \n"
+        " }                                                               \n",
+        gpu_compute_sampler[kind], acc, acc);
+  }
+  else if (is_arg)
+  {
+    SDL_snprintf(
+        load, sizeof(load),
+        " layout(binding = 0) uniform usampler2DArray s_in;               \n"
+        "                                                                 \n"
+        " %s load(int p, out uint index)                                  \n"
+        " {                                                               \n"
+        "   int t = p / 2;                                                \n"
+        "   ivec3 xy = ivec3(t %% %d, t / %d, 0);                         \n"
+        "   uvec4 texel = texelFetch(s_in, xy, 0);                        \n"
+        "   uvec2 pair = (p %% 2) == 0 ? texel.xy : texel.zw;             \n"
+        "   index = pair.y;                                               \n"
+        "   return %s(pair.x);                                            \n"
+        " }                                                               \n",
+        acc, GPU_REDUCE_WIDTH, GPU_REDUCE_WIDTH, decode);
+  }
+  else
+  {
+    SDL_snprintf(
+        load, sizeof(load),
+        " layout(binding = 0) uniform %ssampler2DArray s_in;              \n"
+        "                                                                 \n"
+        " %s load(int p, out uint index)                                  \n"
+        " {                                                               \n"
+        "   int t = p / 4;                                                \n"
+        "   ivec3 xy = ivec3(t %% %d, t / %d, 0);                         \n"
+        "   index = 0u;                                                   \n"
+        "   return texelFetch(s_in, xy, 0)[p %% 4];                       \n"
+        " }                                                               \n",
+        gpu_compute_sampler[acc_kind], acc, GPU_REDUCE_WIDTH,
+        GPU_REDUCE_WIDTH);
+  }
+
+  char store[256] = {};
+
+  if (is_arg)
+    SDL_snprintf(
+        store, sizeof(store),
+        "     o[c * 2 + 0] = %s(v);                                       \n"
+        "     o[c * 2 + 1] = index;                                       \n",
+        encode);
+  else
+    SDL_snprintf(
+        store, sizeof(store),
+        "     o[c] = v;                                                   \n");
+
+  char frag_string[4096] = {};
+
+  // Output partial k * packed + c reduces input partials
+  // [(k * packed + c) * GPU_REDUCE_GROUP, + GPU_REDUCE_GROUP), id of them
+  // exist
+  SDL_snprintf(
+      frag_string, sizeof(frag_string),
+      "%s"
+      "%s"
+      "                                                                   \n"
+      " out %s o;                                                         \n"
+      "                                                                   \n"
+      " void main()                                                       \n"
+      " {                                                                 \n"
+      "   int k = int(gl_FragCoord.y) * %d + int(gl_FragCoord.x);         \n"
+      "                                                                   \n"
+      "   for (int c = 0; c < %d; ++c)                                    \n"
+      "   {                                                               \n"
+      "     int first = (k * %d + c) * %d;                                \n"
+      "     %s v = %s;                                                    \n"
+      "     uint index = 0xFFFFFFFFu;                                     \n"
+      "                                                                   \n"
+      "     for (int j = 0; j < %d && first + j < id; ++j)                \n"
+      "     {                                                             \n"
+      "       uint i;                                                     \n"
+      "       %s value = load(first + j, i);                              \n"
+      "       %s                                                          \n"
+      "     }                                                             \n"
+      "                                                                   \n"
+      "%s"
+      "   }                                                               \n"
+      " }                                                                 \n",
+      gpu_reduce_head, load, out_type, GPU_REDUCE_WIDTH, packed, packed,
+      GPU_REDUCE_GROUP, acc, identity, GPU_REDUCE_GROUP, acc, update, store);
+
+  return gpu_compute_ppo(
+      gpu_vert_head
+      " void main()                                                       \n"
+      " {                                                                 \n"
+      "   vec2 xy = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);        \n"
+      "   gl_Position = vec4(xy * 2.0 - 1.0, 0, 1);                       \n"
+      " }                                                                 \n",
+      NULL, frag_string);
+}
+
+// Reduces count elements of a gpu_x_f32_t, gpu_x_i32_t or gpu_x_u32_t array
+// at mem + bytes_first in passes of GPU_REDUCE_GROUP partials each, packed
+// into RGBA render targets, and reads back only the result. index gets the
+// position of the argmin or argmax, the first one on ties, and -1 for other
+// ops. Int sums wrap, means divide a float sum by count. Returns false on
+// bad arguments or a GLSL error.
+static inline bool gpu_reduce(
+    enum gpu_reduce_t op, void * _Nonnull mem,
+    enum gpu_tex_mem_format_t format, ptrdiff_t bytes_first, int32_t count,
+    double * _Nonnull value, int32_t * _Nullable index)
+{
+  int32_t kind = format == gpu_x_f32_t   ? 0
+                 : format == gpu_x_i32_t ? 1
+                 : format == gpu_x_u32_t ? 2
+                                         : -1;
+
+  if (kind < 0 || count <= 0)
+    return false;
+
+  bool is_arg = op == gpu_argmin_t || op == gpu_argmax_t;
+  int32_t packed = is_arg ? 2 : 4;
+  int32_t acc_kind = op == gpu_mean_t ? 0 : kind;
+
+  gpu_compute_cache.call += 1;
+
+  struct gpu_compute_pro_t first_pro = gpu_reduce_ppo(op, kind, true);
+  struct gpu_compute_pro_t next_pro = gpu_reduce_ppo(op, kind, false);
+
+  if (first_pro.ppo == 0 || next_pro.ppo == 0)
+    return false;
+
+  enum gpu_tex_format_t tex_format = is_arg          ? gpu_rgba_u32_t
+                                     : acc_kind == 0 ? gpu_rgba_f32_t
+                                     : acc_kind == 1 ? gpu_rgba_i32_t
+                                                     : gpu_rgba_u32_t;
+
+  // Ping-pong targets sized for the first two passes, later passes shrink
+  uint32_t tex[2] = {};
+  uint32_t fbo[2] = {};
+  int32_t partials = count;
+
+  for (int32_t i = 0; i < 2; ++i)
+  {
+    partials = (partials + GPU_REDUCE_GROUP - 1) / GPU_REDUCE_GROUP;
+    int32_t texels = (partials + packed - 1) / packed;
+    int32_t height = (texels + GPU_REDUCE_WIDTH - 1) / GPU_REDUCE_WIDTH;
+
+    tex[i] = gpu_malloc_img(tex_format, GPU_REDUCE_WIDTH, height, 1, 1);
+    fbo[i] = gpu_fbo(tex[i], 0, 0, 0, 0, 0, 0, 0, 0, 0);
+  }
+
+  uint32_t smp = gpu_compute_smp();
+  uint32_t in_tex = gpu_cast(mem, format, bytes_first, (ptrdiff_t)count * 4);
+  uint32_t buf_tex = in_tex;
+  int32_t in_count = count;
+  int32_t pass = 0;
+
+  struct gpu_cmd_t cmd = {};
+  cmd.count = 3;
+  cmd.instance_count = 1;
+
+  gpu_compute_begin();
+
+  do
+  {
+    int32_t out_count = (in_count + GPU_REDUCE_GROUP - 1) / GPU_REDUCE_GROUP;
+    int32_t texels = (out_count + packed - 1) / packed;
+    struct gpu_compute_pro_t pro = pass == 0 ? first_pro : next_pro;
+
+    glBindFramebuffer(36009, fbo[pass % 2]); // GL_DRAW_FRAMEBUFFER
+    glViewport(
+        0, 0, texels < GPU_REDUCE_WIDTH ? texels : GPU_REDUCE_WIDTH,
+        (texels + GPU_REDUCE_WIDTH - 1) / GPU_REDUCE_WIDTH);
+
+    struct gpu_ops_t ops = {};
+    ops.id = in_count;
+    ops.tex_count = 1;
+    ops.smp_count = 1;
+    ops.tex = &in_tex;
+    ops.smp = &smp;
+    ops.frag = pro.frag;
+    ops.ppo = pro.ppo;
+    ops.mode = gpu_triangles_t;
+    ops.cmd_count = 1;
+    ops.cmd = &cmd;
+
+    gpu_draw(1, &ops);
+
+    in_tex = tex[pass % 2];
+    in_count = out_count;
+    pass += 1;
+  } while (in_count > 1);
+
+  gpu_compute_end();
+
+  union
+  {
+    float f32[4];
+    int32_t i32[4];
+    uint32_t u32[4];
+  } texel = {};
+
+  if (tex_format == gpu_rgba_f32_t)
+    gpu_get(in_tex, 0, 0, 0, 1, 1, gpu_rgba_t, gpu_f32_t, 16, &texel);
+  else if (tex_format == gpu_rgba_i32_t)
+    gpu_get(in_tex, 0, 0, 0, 1, 1, gpu_rgba_int_t, gpu_i32_t, 16, &texel);
+  else
+    gpu_get(in_tex, 0, 0, 0, 1, 1, gpu_rgba_int_t, gpu_u32_t, 16, &texel);
+
+  if (is_arg)
+  {
+    *value = kind == 0   ? (double)texel.f32[0]
+             : kind == 1 ? (double)texel.i32[0]
+                         : (double)texel.u32[0];
+  }
+  else
+  {
+    *value = acc_kind == 0   ? (double)texel.f32[0]
+             : acc_kind == 1 ? (double)texel.i32[0]
+                             : (double)texel.u32[0];
+  }
+
+  if (op == gpu_mean_t)
+    *value /= (double)count;
+
+  if (index)
+    *index = is_arg ? (int32_t)texel.u32[1] : -1;
+
+  glDeleteFramebuffers(2, fbo);
+  glDeleteTextures(2, tex);
+  glDeleteTextures(1, &buf_tex);
+
+  return true;
+}
+
+#ifndef GPU_SCAN_RADIX
+#define GPU_SCAN_RADIX 4
+#endif
+
+static inline struct gpu_compute_pro_t
+gpu_scan_ppo(enum gpu_reduce_t op, int32_t kind, int32_t shift)
+{
+  const char * acc = gpu_compute_glsl[kind][1];
+  char vert_string[4096] = {};
+
+  // Radix-R Hillis-Steele: after a pass with stride id every element holds
+  // the scan of the R * id elements ending at it
+  SDL_snprintf(
+      vert_string, sizeof(vert_string),
+      "%s layout(location = 0) uniform int id;                            \n"
+      " layout(binding = 0) uniform %ssamplerBuffer s_in;                 \n"
+      "                                                                   \n"
+      " out %s o;                                                         \n"
+      "                                                                   \n"
+      " %s load(int j)                                                    \n"
+      " {                                                                 \n"
+      "   return j >= %d ? texelFetch(s_in, j - %d).x : %s;               \n"
+      " }                                                                 \n"
+      "                                                                   \n"
+      " void main()                                                       \n"
+      " {                                                                 \n"
+      "   %s v = load(gl_VertexID);                                       \n"
+      "                                                                   \n"
+      "   for (int r = 1; r < %d; ++r)                                    \n"
+      "   {                                                               \n"
+      "     %s value = load(gl_VertexID - r * id);                        \n"
+      "     %s                                                            \n"
+      "   }                                                               \n"
+      "                                                                   \n"
+      "   o = v;                                                          \n"
+      " }                                                                 \n",
+      gpu_vert_head, gpu_compute_sampler[kind], acc, acc, shift, shift,
+      gpu_reduce_identity(op, kind), acc, GPU_SCAN_RADIX, acc,
+      gpu_reduce_update(op));
+
+  return gpu_compute_ppo(vert_string, NULL, NULL);
+}
+
+// Writes the inclusive or exclusive gpu_sum_t, gpu_min_t or gpu_max_t scan
+// of count elements of a gpu_x_f32_t, gpu_x_i32_t or gpu_x_u32_t array to
+// out_mem + out_bytes_first, which must not overlap the input. Takes
+// log_R(count) transform feedback passes, ping-ponging between out_mem and
+// a scratch gpu_malloc buffer. Returns a fence, NULL on bad arguments or a
+// GLSL error.
+static inline void * _Nullable gpu_scan(
+    enum gpu_reduce_t op, bool is_exclusive, void * _Nonnull in_mem,
+    enum gpu_tex_mem_format_t format, ptrdiff_t in_bytes_first,
+    int32_t count, void * _Nonnull out_mem, ptrdiff_t out_bytes_first)
+{
+  int32_t kind = format == gpu_x_f32_t   ? 0
+                 : format == gpu_x_i32_t ? 1
+                 : format == gpu_x_u32_t ? 2
+                                         : -1;
+
+  if (kind < 0 || count <= 0 ||
+      (op != gpu_sum_t && op != gpu_min_t && op != gpu_max_t))
+    return NULL;
+
+  gpu_compute_cache.call += 1;
+
+  struct gpu_compute_pro_t first_pro =
+      gpu_scan_ppo(op, kind, is_exclusive ? 1 : 0);
+  struct gpu_compute_pro_t next_pro = gpu_scan_ppo(op, kind, 0);
+
+  if (first_pro.ppo == 0 || next_pro.ppo == 0)
+    return NULL;
+
+  ptrdiff_t bytes = (ptrdiff_t)count * 4;
+  void * scratch = gpu_malloc(bytes);
+
+  if (scratch == NULL)
+    return NULL;
+
+  int32_t pass_count = 0;
+  for (int64_t stride = 1; pass_count == 0 || stride < count;
+       stride *= GPU_SCAN_RADIX)
+    pass_count += 1;
+
+  // Passes alternate targets so that the last one writes out_mem
+  uint32_t in_tex = gpu_cast(in_mem, format, in_bytes_first, bytes);
+  uint32_t tex[2] = {
+      gpu_cast(out_mem, format, out_bytes_first, bytes),
+      gpu_cast(scratch, format, 0, bytes),
+  };
+  uint32_t xfb[2] = {
+      gpu_xfb(out_mem, out_bytes_first, bytes, NULL, 0, 0, NULL, 0, 0, NULL,
+              0, 0),
+      gpu_xfb(scratch, 0, bytes, NULL, 0, 0, NULL, 0, 0, NULL, 0, 0),
+  };
+
+  struct gpu_cmd_t cmd = {};
+  cmd.count = count;
+  cmd.instance_count = 1;
+
+  gpu_compute_begin();
+  gpu_compute_bind_discard();
+  glEnable(35977); // GL_RASTERIZER_DISCARD
+
+  uint32_t read_tex = in_tex;
+  int32_t stride = 1;
+
+  for (int32_t pass = 0; pass < pass_count; ++pass)
+  {
+    int32_t target = (pass_count - 1 - pass) % 2;
+    struct gpu_compute_pro_t pro = pass == 0 ? first_pro : next_pro;
+
+    struct gpu_ops_t ops = {};
+    ops.id = stride;
+    ops.tex_count = 1;
+    ops.tex = &read_tex;
+    ops.vert = pro.vert;
+    ops.ppo = pro.ppo;
+    ops.mode = gpu_points_t;
+    ops.cmd_count = 1;
+    ops.cmd = &cmd;
+
+    gpu_bind_xfb(xfb[target]);
+    gpu_draw_xfb(1, &ops);
+
+    read_tex = tex[target];
+    stride = stride > INT32_MAX / GPU_SCAN_RADIX ? INT32_MAX
+                                                 : stride * GPU_SCAN_RADIX;
+  }
+
+  gpu_bind_xfb(0);
+  glDisable(35977); // GL_RASTERIZER_DISCARD
+  gpu_compute_end();
+
+  glDeleteTransformFeedbacks(2, xfb);
+  glDeleteTextures(2, tex);
+  glDeleteTextures(1, &in_tex);
+  gpu_free(scratch);
+
+  return gpu_fence();
+}
+
+// Appends, in order, each of the count elements for which pred holds to
+// out_mem + out_bytes_first. pred sees the element as i0, typed after
+// format which must have 32 bit components, and its index as i, e.g.
+// "i0.w > 0.0". A geometry stage drops the rest before transform feedback.
+// Returns a GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN query for
+// gpu_compact_count, 0 on bad arguments or a GLSL error.
+static inline uint32_t gpu_compact(
+    const char * _Nonnull pred, void * _Nonnull in_mem,
+    enum gpu_tex_mem_format_t format, ptrdiff_t in_bytes_first,
+    int32_t count, void * _Nonnull out_mem, ptrdiff_t out_bytes_first)
+{
+  struct gpu_compute_type_t type = gpu_compute_type(format);
+
+  if (count <= 0 || type.bytes != 4)
+    return 0;
+
+  const char * t = gpu_compute_glsl[type.kind][type.components];
+  char geom_string[GPU_MAP_SOURCE_BYTES] = {};
+
+  int32_t n = SDL_snprintf(
+      geom_string, sizeof(geom_string),
+      "%s layout(points) in;                                              \n"
+      " layout(points, max_vertices = 1) out;                             \n"
+      " layout(binding = 0) uniform %ssamplerBuffer s_i0;                 \n"
+      " layout(location = 0) in int v_i[];                                \n"
+      "                                                                   \n"
+      " out %s o;                                                         \n"
+      "                                                                   \n"
+      " void main()                                                       \n"
+      " {                                                                 \n"
+      "   int i = v_i[0];                                                 \n"
+      "   %s i0 = texelFetch(s_i0, i).%s;                                 \n"
+      "                                                                   \n"
+      "   if (%s)                                                         \n"
+      "   {                                                               \n"
+      "     o = i0;                                                       \n"
+      "     EmitVertex();                                                 \n"
+      "   }                                                               \n"
+      " }                                                                 \n",
+      gpu_geom_head, gpu_compute_sampler[type.kind], t, t,
+      gpu_compute_swizzle[type.components], pred);
+
+  if (n < 0 || n >= GPU_MAP_SOURCE_BYTES)
+    return 0;
+
+  gpu_compute_cache.call += 1;
+
+  struct gpu_compute_pro_t pro = gpu_compute_ppo(
+      gpu_vert_head " layout(location = 0) out int v_i;                    \n"
+                    "                                                      \n"
+                    " void main()                                          \n"
+                    " {                                                    \n"
+                    "   v_i = gl_VertexID;                                 \n"
+                    " }                                                    \n",
+      geom_string, NULL);
+
+  if (pro.ppo == 0)
+    return 0;
+
+  ptrdiff_t bytes = (ptrdiff_t)count * type.components * 4;
+  uint32_t tex = gpu_cast(in_mem, format, in_bytes_first, bytes);
+  uint32_t xfb = gpu_xfb(
+      out_mem, out_bytes_first, bytes, NULL, 0, 0, NULL, 0, 0, NULL, 0, 0);
+
+  uint32_t query = 0;
+  glCreateQueries(35976, 1, &query); // GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN
+
+  struct gpu_cmd_t cmd = {};
+  cmd.count = count;
+  cmd.instance_count = 1;
+
+  struct gpu_ops_t ops = {};
+  ops.tex_count = 1;
+  ops.tex = &tex;
+  ops.ppo = pro.ppo;
+  ops.mode = gpu_points_t;
+  ops.cmd_count = 1;
+  ops.cmd = &cmd;
+
+  gpu_compute_begin();
+  gpu_compute_bind_discard();
+  glEnable(35977); // GL_RASTERIZER_DISCARD
+  gpu_bind_xfb(xfb);
+  glBeginQuery(35976, query); // GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN
+  gpu_draw_xfb(1, &ops);
+  glEndQuery(35976); // GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN
+  gpu_bind_xfb(0);
+  glDisable(35977); // GL_RASTERIZER_DISCARD
+  gpu_compute_end();
+
+  glDeleteTransformFeedbacks(1, &xfb);
+  glDeleteTextures(1, &tex);
+
+  // Polling the query alone doesn't submit the draw
+  glFlush();
+
+  return query;
+}
+
+// Returns how many elements a gpu_compact call wrote and deletes its query.
+// Without is_wait returns -1 instead of stalling while the count isn't
+// available yet. Once it is the output can be read.
+static inline int32_t gpu_compact_count(uint32_t query, bool is_wait)
+{
+  if (!is_wait)
+  {
+    int32_t is_available = 0;
+    // GL_QUERY_RESULT_AVAILABLE
+    glGetQueryObjectiv(query, 34919, &is_available);
+
+    if (!is_available)
+      return -1;
+  }
+
+  int32_t count = 0;
+  glGetQueryObjectiv(query, 34918, &count); // GL_QUERY_RESULT
+  glDeleteQueries(1, &query);
+
+  return count;
+}
+
+#define GPU_SORT_WIDTH 4096
+
+#define gpu_sort_vert                                                          \
+  gpu_vert_head                                                                \
+      " void main()                                                       \n" \
+      " {                                                                 \n" \
+      "   vec2 xy = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);        \n" \
+      "   gl_Position = vec4(xy * 2.0 - 1.0, 0, 1);                       \n" \
+      " }                                                                 \n"
+
+// Keys are sorted as uints: float bits are flipped so that their uint order
+// matches the float order, int bits get their sign bit flipped
+static inline struct gpu_compute_pro_t
+gpu_sort_pack_ppo(int32_t kind, bool has_values)
+{
+  const char * key = kind == 0 ? " uint b = floatBitsToUint(key);           \n"
+                                 " o.x = (b & 0x80000000u) != 0u            \n"
+                                 "     ? ~b : b ^ 0x80000000u;              \n"
+                     : kind == 1 ? " o.x = uint(key) ^ 0x80000000u;         \n"
+                                   : " o.x = key;                           \n";
+
+  char frag_string[4096] = {};
+
+  SDL_snprintf(
+      frag_string, sizeof(frag_string),
+      "%s layout(location = 1) uniform int count;                         \n"
+      " layout(binding = 0) uniform %ssamplerBuffer s_key;                \n"
+      " layout(binding = 1) uniform usamplerBuffer s_value;               \n"
+      "                                                                   \n"
+      " out uvec2 o;                                                      \n"
+      "                                                                   \n"
+      " void main()                                                       \n"
+      " {                                                                 \n"
+      "   int i = int(gl_FragCoord.y) * %d + int(gl_FragCoord.x);         \n"
+      "   if (i >= count)                                                 \n"
+      "     discard;                                                      \n"
+      "                                                                   \n"
+      "   %s key = texelFetch(s_key, i).x;                                \n"
+      "%s"
+      "   o.y = %s;                                                       \n"
+      " }                                                                 \n",
+      gpu_frag_head, gpu_compute_sampler[kind], GPU_SORT_WIDTH,
+      gpu_compute_glsl[kind][1], key,
+      has_values ? "texelFetch(s_value, i).x" : "uint(i)");
+
+  return gpu_compute_ppo(gpu_sort_vert, NULL, frag_string);
+}
+
+// One step of the bitonic network in its all-ascending form: the first
+// step of each block of size block compares i with its mirror i ^ (block -
+// 1), later steps with i ^ id. Elements past count act as padding sorted
+// last, so comparisons against them never swap.
+static inline struct gpu_compute_pro_t gpu_sort_step_ppo(bool is_descending)
+{
+  char frag_string[4096] = {};
+
+  SDL_snprintf(
+      frag_string, sizeof(frag_string),
+      "%s layout(location = 0) uniform int id;                            \n"
+      " layout(location = 1) uniform int count;                           \n"
+      " layout(location = 2) uniform int block;                           \n"
+      " layout(binding = 0) uniform usampler2DArray s_in;                 \n"
+      "                                                                   \n"
+      " out uvec2 o;                                                      \n"
+      "                                                                   \n"
+      " uvec2 load(int i)                                                 \n"
+      " {                                                                 \n"
+      "   return texelFetch(s_in, ivec3(i %% %d, i / %d, 0), 0).xy;       \n"
+      " }                                                                 \n"
+      "                                                                   \n"
+      " bool less(uvec2 a, uvec2 b)                                       \n"
+      " {                                                                 \n"
+      "   return a.x < b.x || (a.x == b.x && a.y < b.y);                  \n"
+      " }                                                                 \n"
+      "                                                                   \n"
+      " void main()                                                       \n"
+      " {                                                                 \n"
+      "   int i = int(gl_FragCoord.y) * %d + int(gl_FragCoord.x);         \n"
+      "   if (i >= count)                                                 \n"
+      "     discard;                                                      \n"
+      "                                                                   \n"
+      "   int p = id == block / 2 ? i ^ (block - 1) : i ^ id;             \n"
+      "   uvec2 self = load(i);                                           \n"
+      "                                                                   \n"
+      "   if (p >= count)                                                 \n"
+      "   {                                                               \n"
+      "     o = self;                                                     \n"
+      "     return;                                                       \n"
+      "   }                                                               \n"
+      "                                                                   \n"
+      "   uvec2 other = load(p);                                          \n"
+      "   bool is_low = (i < p) != %s;                                    \n"
+      "   o = (is_low ? less(other, self) : less(self, other))            \n"
+      "       ? other : self;                                             \n"
+      " }                                                                 \n",
+      gpu_frag_head, GPU_SORT_WIDTH, GPU_SORT_WIDTH, GPU_SORT_WIDTH,
+      is_descending ? "true" : "false");
+
+  return gpu_compute_ppo(gpu_sort_vert, NULL, frag_string);
+}
+
+// Sorts count gpu_x_f32_t, gpu_x_i32_t or gpu_x_u32_t keys at keys +
+// keys_bytes_first in place, and with values the 32 bit values at values +
+// values_bytes_first along with them. Pairs are packed into RG32UI
+// targets GPU_SORT_WIDTH texels wide and sorted by a bitonic network of
+// log2(n) * (log2(n) + 1) / 2 fragment passes, equal keys are ordered by
+// value. Up to GPU_SORT_WIDTH * GL_MAX_TEXTURE_SIZE pairs. Returns a
+// fence, NULL on bad arguments or a GLSL error.
+static inline void * _Nullable gpu_sort(
+    void * _Nonnull keys, enum gpu_tex_mem_format_t key_format,
+    ptrdiff_t keys_bytes_first, void * _Nullable values,
+    ptrdiff_t values_bytes_first, int32_t count, bool is_descending)
+{
+  int32_t kind = key_format == gpu_x_f32_t   ? 0
+                 : key_format == gpu_x_i32_t ? 1
+                 : key_format == gpu_x_u32_t ? 2
+                                             : -1;
+
+  if (kind < 0 || count <= 0)
+    return NULL;
+
+  gpu_compute_cache.call += 1;
+
+  struct gpu_compute_pro_t pack_pro = gpu_sort_pack_ppo(kind, values != NULL);
+  struct gpu_compute_pro_t step_pro = gpu_sort_step_ppo(is_descending);
+
+  if (pack_pro.ppo == 0 || step_pro.ppo == 0)
+    return NULL;
+
+  int32_t height = (count + GPU_SORT_WIDTH - 1) / GPU_SORT_WIDTH;
+  int32_t width = count < GPU_SORT_WIDTH ? count : GPU_SORT_WIDTH;
+  ptrdiff_t bytes = (ptrdiff_t)count * 4;
+  ptrdiff_t pairs_bytes = (ptrdiff_t)GPU_SORT_WIDTH * height * 8;
+
+  void * pairs = gpu_malloc(pairs_bytes);
+
+  if (pairs == NULL)
+    return NULL;
+
+  uint32_t tex[2] = {};
+  uint32_t fbo[2] = {};
+
+  for (int32_t i = 0; i < 2; ++i)
+  {
+    tex[i] = gpu_malloc_img(gpu_rg_u32_t, GPU_SORT_WIDTH, height, 1, 1);
+    fbo[i] = gpu_fbo(tex[i], 0, 0, 0, 0, 0, 0, 0, 0, 0);
+  }
+
+  uint32_t smp[2] = {gpu_compute_smp(), gpu_compute_smp()};
+  uint32_t in_tex[2] = {
+      gpu_cast(keys, key_format, keys_bytes_first, bytes),
+      values ? gpu_cast(values, gpu_x_u32_t, values_bytes_first, bytes) : 0,
+  };
+
+  struct gpu_cmd_t cmd = {};
+  cmd.count = 3;
+  cmd.instance_count = 1;
+
+  struct gpu_ops_t ops = {};
+  ops.tex_count = values ? 2 : 1;
+  ops.smp_count = 2;
+  ops.tex = in_tex;
+  ops.smp = smp;
+  ops.frag = pack_pro.frag;
+  ops.ppo = pack_pro.ppo;
+  ops.mode = gpu_triangles_t;
+  ops.cmd_count = 1;
+  ops.cmd = &cmd;
+
+  gpu_compute_begin();
+  glViewport(0, 0, width, height);
+
+  gpu_i32(ops.frag, 1, 1, &count);
+  glBindFramebuffer(36009, fbo[0]); // GL_DRAW_FRAMEBUFFER
+  gpu_draw(1, &ops);
+
+  uint32_t step_frag = step_pro.frag;
+  gpu_i32(step_frag, 1, 1, &count);
+
+  int32_t read = 0;
+
+  for (int64_t block = 2; block < 2 * (int64_t)count; block *= 2)
+  {
+    int32_t block_i32 = (int32_t)block;
+    gpu_i32(step_frag, 2, 1, &block_i32);
+
+    for (int32_t step = block_i32 / 2; step >= 1; step /= 2)
+    {
+      struct gpu_ops_t step_ops = ops;
+      step_ops.id = step;
+      step_ops.tex_count = 1;
+      step_ops.smp_count = 1;
+      step_ops.tex = &tex[read];
+      step_ops.frag = step_frag;
+      step_ops.ppo = step_pro.ppo;
+
+      glBindFramebuffer(36009, fbo[1 - read]); // GL_DRAW_FRAMEBUFFER
+      gpu_draw(1, &step_ops);
+
+      read = 1 - read;
+    }
+  }
+
+  gpu_compute_end();
+
+  void * fence = gpu_get_mem(
+      tex[read], 0, 0, 0, GPU_SORT_WIDTH, height, gpu_rg_int_t, gpu_u32_t,
+      pairs_bytes, pairs, 0);
+  glDeleteSync(fence);
+
+  const char * unpack = kind == 0 ? "uintBitsToFloat((i0.x & 0x80000000u) != 0u"
+                                    " ? i0.x ^ 0x80000000u : ~i0.x)"
+                        : kind == 1 ? "int(i0.x ^ 0x80000000u)"
+                                    : "i0.x";
+
+  struct gpu_map_in_t in = {pairs, gpu_xy_u32_t, 0};
+
+  fence = gpu_map(unpack, count, keys, key_format, keys_bytes_first, 1, &in);
+
+  if (values)
+  {
+    glDeleteSync(fence);
+    fence =
+        gpu_map("i0.y", count, values, gpu_x_u32_t, values_bytes_first, 1, &in);
+  }
+
+  glDeleteFramebuffers(2, fbo);
+  glDeleteTextures(2, tex);
+  glDeleteTextures(values ? 2 : 1, in_tex);
+  gpu_free(pairs);
+
+  return fence;
+}
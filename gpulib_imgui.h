@@ -97,6 +97,23 @@ struct ImDrawCmd
   void * UserCallbackData;
 };
 
+struct ImFontConfig
+{
+  void * FontData;
+  int32_t FontDataSize;
+  bool FontDataOwnedByAtlas;
+  int32_t FontNo;
+  float SizePixels;
+  int32_t OversampleH, OversampleV;
+  bool PixelSnapH;
+  struct ImVec2 GlyphExtraSpacing;
+  const ImWchar * GlyphRanges;
+  bool MergeMode;
+  bool MergeGlyphCenterV;
+  char Name[32];
+  struct ImFont * DstFont;
+};
+
 typedef struct
 {
   struct ImVec2 pos;
@@ -204,27 +221,289 @@ struct ImGuiStyle
   struct ImVec4 Colors[43];
 };
 
+#define IMGUI_FRAMES_IN_FLIGHT 3
+
+#ifndef IMGUI_MEM_CHUNK_BYTES
+#define IMGUI_MEM_CHUNK_BYTES (256 * 1024)
+#endif
+
+#define IMGUI_MEM_CLASS_MIN 5  // 32 bytes, including the 16 bytes header
+#define IMGUI_MEM_CLASS_MAX 16 // 64 KiB, larger blocks go to SDL_malloc
+
+struct imgui_mem_stats_t
+{
+  int64_t allocs;
+  int64_t frees;
+  int64_t bytes;
+  int64_t peak_bytes;
+};
+
+static struct
+{
+  void * free_list[IMGUI_MEM_CLASS_MAX + 1];
+  void * chunks;
+  uint8_t * bump;
+  ptrdiff_t bump_bytes;
+  int64_t live;
+  struct imgui_mem_stats_t frame, last_frame;
+} g_mem = {};
+
 static double g_time = 0.0;
 static float g_mouse_wheel = 0.f;
 static bool g_is_mouse_pressed[3] = {};
 static uint32_t g_font_texture = 0, g_ppo = 0, g_vert = 0, g_frag = 0;
+static uint32_t g_idx_mem_id = 0, g_vtx_mem_id = 0;
+static uint32_t g_idx_tex_id = 0, g_vtx_f32_tex_id = 0, g_vtx_u32_tex_id = 0;
+static void * g_idx = NULL, * g_vtx = NULL;
+static int32_t g_idx_capacity = 0, g_vtx_capacity = 0, g_frame = 0;
+static void * g_fences[IMGUI_FRAMES_IN_FLIGHT] = {};
+static uint32_t g_layer_tex_id = 0, g_layer_fbo_id = 0;
+static uint32_t g_layer_ppo = 0, g_layer_vert = 0, g_layer_frag = 0;
+static int32_t g_layer_w = 0, g_layer_h = 0;
+static uint64_t g_layer_hash = 0;
+static bool g_layer_is_dirty = true;
+static char g_font_cache_dir[4096] = {};
 
-static void imgui_render_draw_list(struct ImDrawData * draw_data)
+static void imgui_mem_push(int32_t size_class, void * block)
 {
-  struct ImGuiIO * io = igGetIO();
+  *(void **)block = g_mem.free_list[size_class];
+  g_mem.free_list[size_class] = block;
+}
 
-  struct ImVec2 fb_scale = io->DisplayFramebufferScale;
-  int32_t w = (int32_t)(io->DisplaySize.x * fb_scale.x);
-  int32_t h = (int32_t)(io->DisplaySize.y * fb_scale.y);
+// Size-class allocator installed as ImGuiIO::MemAllocFn. Blocks up to 64 KiB
+// are carved from chunks and recycled through per-class free lists, every
+// block starts with a 16 bytes header holding its class and requested size.
+static void * imgui_mem_alloc(size_t bytes)
+{
+  int32_t size_class = IMGUI_MEM_CLASS_MIN;
+  while (size_class <= IMGUI_MEM_CLASS_MAX &&
+         ((size_t)1 << size_class) < bytes + 16)
+    size_class += 1;
 
-  ImDrawData_ScaleClipRects(draw_data, fb_scale);
-  glViewport(0, 0, w, h);
+  int64_t * header = NULL;
 
-  glDisable(/*GL_CULL_FACE*/ 0x0B44);
-  glDisable(/*GL_DEPTH_TEST*/ 0x0B71);
-  glEnable(/*GL_SCISSOR_TEST*/ 0x0C11);
-  glDisable(/*GL_FRAMEBUFFER_SRGB*/ 0x8DB9);
+  if (size_class > IMGUI_MEM_CLASS_MAX)
+  {
+    size_class = 0;
+    header = SDL_malloc(bytes + 16);
+  }
+  else if (g_mem.free_list[size_class])
+  {
+    header = g_mem.free_list[size_class];
+    g_mem.free_list[size_class] = *(void **)header;
+  }
+  else
+  {
+    ptrdiff_t block_bytes = (ptrdiff_t)1 << size_class;
+    if (g_mem.bump_bytes < block_bytes)
+    {
+      uint8_t * chunk = SDL_malloc(IMGUI_MEM_CHUNK_BYTES);
+      if (chunk == NULL)
+        return NULL;
+
+      // The tail of the previous chunk is handed to the free lists
+      for (int32_t c = IMGUI_MEM_CLASS_MAX; c >= IMGUI_MEM_CLASS_MIN; --c)
+      {
+        while (g_mem.bump_bytes >= ((ptrdiff_t)1 << c))
+        {
+          imgui_mem_push(c, g_mem.bump);
+          g_mem.bump += (ptrdiff_t)1 << c;
+          g_mem.bump_bytes -= (ptrdiff_t)1 << c;
+        }
+      }
+
+      *(void **)chunk = g_mem.chunks;
+      g_mem.chunks = chunk;
+      g_mem.bump = chunk + 16;
+      g_mem.bump_bytes = IMGUI_MEM_CHUNK_BYTES - 16;
+    }
+    header = (int64_t *)g_mem.bump;
+    g_mem.bump += block_bytes;
+    g_mem.bump_bytes -= block_bytes;
+  }
+
+  if (header == NULL)
+    return NULL;
+
+  header[0] = size_class;
+  header[1] = (int64_t)bytes;
+
+  g_mem.live += 1;
+  g_mem.frame.allocs += 1;
+  g_mem.frame.bytes += (int64_t)bytes;
+  if (g_mem.frame.peak_bytes < g_mem.frame.bytes)
+    g_mem.frame.peak_bytes = g_mem.frame.bytes;
+
+  return header + 2;
+}
+
+static void imgui_mem_free(void * ptr)
+{
+  if (ptr == NULL)
+    return;
+
+  int64_t * header = (int64_t *)ptr - 2;
+
+  g_mem.live -= 1;
+  g_mem.frame.frees += 1;
+  g_mem.frame.bytes -= header[1];
+
+  if (header[0] == 0)
+    SDL_free(header);
+  else
+    imgui_mem_push((int32_t)header[0], header);
+}
+
+// Returns the allocator statistics of the last completed frame: allocation
+// and free counts, live bytes at its end and peak live bytes during it. The
+// live allocation count is ImGuiIO::MetricsAllocs, maintained by ImGui.
+struct imgui_mem_stats_t imgui_mem_stats()
+{
+  return g_mem.last_frame;
+}
+
+static void imgui_mem_release()
+{
+  while (g_mem.chunks)
+  {
+    void * next = *(void **)g_mem.chunks;
+    SDL_free(g_mem.chunks);
+    g_mem.chunks = next;
+  }
+  SDL_memset(&g_mem, 0, sizeof(g_mem));
+}
+
+static uint64_t imgui_hash(uint64_t hash, const void * data, ptrdiff_t bytes)
+{
+  const uint8_t * p = (const uint8_t *)data;
+  ptrdiff_t i = 0;
+  for (; i + 8 <= bytes; i += 8)
+  {
+    uint64_t word;
+    SDL_memcpy(&word, p + i, 8);
+    hash = (hash ^ word) * 1099511628211ull;
+  }
+  for (; i < bytes; ++i)
+    hash = (hash ^ p[i]) * 1099511628211ull;
+  return hash;
+}
+
+static void imgui_delete_layer()
+{
+  glDeleteFramebuffers(1, &g_layer_fbo_id);
+  glDeleteTextures(1, &g_layer_tex_id);
+  g_layer_tex_id = 0, g_layer_fbo_id = 0;
+  g_layer_w = 0, g_layer_h = 0;
+  g_layer_is_dirty = true;
+}
+
+static void imgui_create_layer(int32_t w, int32_t h)
+{
+  imgui_delete_layer();
+
+  // clang-format off
+  glCreateTextures(35866, 1, &g_layer_tex_id);
+  glTextureStorage3D(g_layer_tex_id, 1, /*GL_RGBA8*/ 0x8058, w, h, 1);
+  glCreateFramebuffers(1, &g_layer_fbo_id);
+  glNamedFramebufferTextureLayer(g_layer_fbo_id, /*GL_COLOR_ATTACHMENT0*/ 0x8CE0, g_layer_tex_id, 0, 0);
+  // clang-format on
+
+  g_layer_w = w;
+  g_layer_h = h;
+}
+
+// Returns true when the draw data differs from the one cached in the layer.
+// Draw lists with user callbacks or textures other than the font atlas are
+// never considered clean, their results can change with the same geometry.
+static bool imgui_layer_is_dirty(struct ImDrawData * draw_data)
+{
+  uint64_t hash = 14695981039346656037ull;
+  bool is_volatile = false;
+  for (ptrdiff_t i = 0, c = draw_data->CmdListsCount; i < c; ++i)
+  {
+    struct ImDrawList * cmd_list = draw_data->CmdLists[i];
+    ptrdiff_t idx_size = ImDrawList_GetIndexBufferSize(cmd_list);
+    ptrdiff_t vtx_size = ImDrawList_GetVertexBufferSize(cmd_list);
+    hash = imgui_hash(
+        hash, ImDrawList_GetIndexPtr(cmd_list, 0),
+        idx_size * (ptrdiff_t)sizeof(ImDrawIdx));
+    hash = imgui_hash(
+        hash, ImDrawList_GetVertexPtr(cmd_list, 0),
+        vtx_size * (ptrdiff_t)sizeof(ImDrawVtx));
+    for (ptrdiff_t j = 0, c = ImDrawList_GetCmdSize(cmd_list); j < c; ++j)
+    {
+      struct ImDrawCmd * pcmd = ImDrawList_GetCmdPtr(cmd_list, (int32_t)j);
+      uint32_t texture = pcmd->TextureId ? *(uint32_t *)pcmd->TextureId : 0;
+      hash = imgui_hash(hash, &pcmd->ElemCount, sizeof(pcmd->ElemCount));
+      hash = imgui_hash(hash, &pcmd->ClipRect, sizeof(pcmd->ClipRect));
+      hash = imgui_hash(hash, &texture, sizeof(texture));
+      is_volatile = is_volatile || pcmd->UserCallback != NULL ||
+                    (texture != 0 && texture != g_font_texture);
+    }
+  }
 
+  bool is_dirty = g_layer_is_dirty || hash != g_layer_hash;
+  g_layer_hash = hash;
+  g_layer_is_dirty = is_volatile;
+  return is_dirty;
+}
+
+static void imgui_delete_streaming_buffers()
+{
+  for (ptrdiff_t i = 0; i < IMGUI_FRAMES_IN_FLIGHT; ++i)
+  {
+    if (g_fences[i])
+      glDeleteSync(g_fences[i]);
+    g_fences[i] = NULL;
+  }
+
+  glDeleteBuffers(1, &g_idx_mem_id);
+  glDeleteBuffers(1, &g_vtx_mem_id);
+  glDeleteTextures(1, &g_idx_tex_id);
+  glDeleteTextures(1, &g_vtx_f32_tex_id);
+  glDeleteTextures(1, &g_vtx_u32_tex_id);
+  g_idx_mem_id = 0, g_vtx_mem_id = 0;
+  g_idx_tex_id = 0, g_vtx_f32_tex_id = 0, g_vtx_u32_tex_id = 0;
+  g_idx = NULL, g_vtx = NULL;
+  g_idx_capacity = 0, g_vtx_capacity = 0;
+}
+
+static void imgui_create_streaming_buffers(int32_t idx_count, int32_t vtx_count)
+{
+  int32_t idx_capacity = g_idx_capacity > 0 ? g_idx_capacity : 1024;
+  int32_t vtx_capacity = g_vtx_capacity > 0 ? g_vtx_capacity : 1024;
+
+  while (idx_capacity < idx_count)
+    idx_capacity *= 2;
+  while (vtx_capacity < vtx_count)
+    vtx_capacity *= 2;
+
+  imgui_delete_streaming_buffers();
+
+  // clang-format off
+  ptrdiff_t idx_bytes = IMGUI_FRAMES_IN_FLIGHT * idx_capacity * (ptrdiff_t)sizeof(uint32_t);
+  ptrdiff_t vtx_bytes = IMGUI_FRAMES_IN_FLIGHT * vtx_capacity * (ptrdiff_t)sizeof(ImDrawVtx);
+  glCreateBuffers(1, &g_idx_mem_id);
+  glCreateBuffers(1, &g_vtx_mem_id);
+  glNamedBufferStorage(g_idx_mem_id, idx_bytes, 0, 194);
+  glNamedBufferStorage(g_vtx_mem_id, vtx_bytes, 0, 194);
+  g_idx = glMapNamedBufferRange(g_idx_mem_id, 0, idx_bytes, 194);
+  g_vtx = glMapNamedBufferRange(g_vtx_mem_id, 0, vtx_bytes, 194);
+  glCreateTextures(35882, 1, &g_idx_tex_id);
+  glCreateTextures(35882, 1, &g_vtx_f32_tex_id);
+  glCreateTextures(35882, 1, &g_vtx_u32_tex_id);
+  glTextureBufferRange(g_idx_tex_id, /*GL_R32UI*/ 0x8236, g_idx_mem_id, 0, idx_bytes);
+  glTextureBufferRange(g_vtx_f32_tex_id, /*GL_R32F*/ 0x822E, g_vtx_mem_id, 0, vtx_bytes);
+  glTextureBufferRange(g_vtx_u32_tex_id, /*GL_R32UI*/ 0x8236, g_vtx_mem_id, 0, vtx_bytes);
+  // clang-format on
+
+  g_idx_capacity = idx_capacity;
+  g_vtx_capacity = vtx_capacity;
+}
+
+static void
+imgui_render_layer(struct ImDrawData * draw_data, int32_t w, int32_t h)
+{
   float scale[2], translate[2];
   scale[0] = 2.f / w;
   scale[1] = 2.f / -h;
@@ -234,54 +513,59 @@ static void imgui_render_draw_list(struct ImDrawData * draw_data)
   glProgramUniform2fv(g_vert, 1, 1, translate);
   glBindProgramPipeline(g_ppo);
 
-  ptrdiff_t idx_bytes = draw_data->TotalIdxCount * (ptrdiff_t)sizeof(ImDrawIdx);
-  ptrdiff_t vtx_bytes = draw_data->TotalVtxCount * (ptrdiff_t)sizeof(ImDrawVtx);
+  g_frame = (g_frame + 1) % IMGUI_FRAMES_IN_FLIGHT;
 
-  // clang-format off
-  uint32_t idx_mem_id = 0;
-  uint32_t vtx_mem_id = 0;
-  glCreateBuffers(1, &idx_mem_id);
-  glCreateBuffers(1, &vtx_mem_id);
-  glNamedBufferStorage(idx_mem_id, idx_bytes, 0, 194);
-  glNamedBufferStorage(vtx_mem_id, vtx_bytes, 0, 194);
-  void * idx = glMapNamedBufferRange(idx_mem_id, 0, idx_bytes, 194);
-  void * vtx = glMapNamedBufferRange(vtx_mem_id, 0, vtx_bytes, 194);
-  uint32_t idx_tex_id = 0;
-  uint32_t vtx_f32_tex_id = 0;
-  uint32_t vtx_u32_tex_id = 0;
-  glCreateTextures(35882, 1, &idx_tex_id);
-  glCreateTextures(35882, 1, &vtx_f32_tex_id);
-  glCreateTextures(35882, 1, &vtx_u32_tex_id);
-  glTextureBufferRange(idx_tex_id, /*GL_R16UI*/ 0x8234, idx_mem_id, 0, idx_bytes);
-  glTextureBufferRange(vtx_f32_tex_id, /*GL_R32F*/ 0x822E, vtx_mem_id, 0, vtx_bytes);
-  glTextureBufferRange(vtx_u32_tex_id, /*GL_R32UI*/ 0x8236, vtx_mem_id, 0, vtx_bytes);
-  // clang-format on
+  if (g_fences[g_frame])
+  {
+    // GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_EXPIRED
+    while (glClientWaitSync(g_fences[g_frame], 1, 1000000) == 0x911B)
+      ;
+    glDeleteSync(g_fences[g_frame]);
+    g_fences[g_frame] = NULL;
+  }
+
+  if (draw_data->TotalIdxCount > g_idx_capacity ||
+      draw_data->TotalVtxCount > g_vtx_capacity)
+    imgui_create_streaming_buffers(
+        draw_data->TotalIdxCount, draw_data->TotalVtxCount);
+
+  int32_t idx_first = g_frame * g_idx_capacity;
+  int32_t vtx_first = g_frame * g_vtx_capacity;
 
-  ImDrawIdx * idx_dest = idx;
-  ImDrawVtx * vtx_dest = vtx;
+  // Indices are stored as 32-bit with the vertex offset of their draw list
+  // folded in, so commands can be drawn without a per-command uniform and
+  // adjacent commands can be merged across draw lists.
+  uint32_t * idx_dest = (uint32_t *)g_idx + idx_first;
+  ImDrawVtx * vtx_dest = (ImDrawVtx *)g_vtx + vtx_first;
+  uint32_t vtx_offset = (uint32_t)vtx_first;
   for (ptrdiff_t i = 0, c = draw_data->CmdListsCount; i < c; ++i)
   {
     struct ImDrawList * cmd_list = draw_data->CmdLists[i];
     int32_t idx_size = ImDrawList_GetIndexBufferSize(cmd_list);
     int32_t vtx_size = ImDrawList_GetVertexBufferSize(cmd_list);
-    SDL_memcpy(
-        idx_dest, ImDrawList_GetIndexPtr(cmd_list, 0),
-        (size_t)idx_size * sizeof(ImDrawIdx));
+    ImDrawIdx * idx_src = ImDrawList_GetIndexPtr(cmd_list, 0);
+    for (ptrdiff_t k = 0; k < idx_size; ++k)
+      idx_dest[k] = vtx_offset + idx_src[k];
     SDL_memcpy(
         vtx_dest, ImDrawList_GetVertexPtr(cmd_list, 0),
         (size_t)vtx_size * sizeof(ImDrawVtx));
     idx_dest += idx_size;
     vtx_dest += vtx_size;
+    vtx_offset += (uint32_t)vtx_size;
   }
 
   uint32_t input[4];
   input[0] = 0;
-  input[1] = vtx_f32_tex_id;
-  input[2] = vtx_u32_tex_id;
-  input[3] = idx_tex_id;
+  input[1] = g_vtx_f32_tex_id;
+  input[2] = g_vtx_u32_tex_id;
+  input[3] = g_idx_tex_id;
 
-  int32_t idx_offset = 0;
-  int32_t vtx_offset = 0;
+  int32_t idx_offset = idx_first;
+  int32_t draw_first = idx_first;
+  int32_t draw_count = 0;
+  bool is_bound = false;
+  bool is_clipped = false;
+  struct ImVec4 clip_rect = {};
   for (ptrdiff_t i = 0, c = draw_data->CmdListsCount; i < c; ++i)
   {
     struct ImDrawList * cmd_list = draw_data->CmdLists[i];
@@ -290,33 +574,103 @@ static void imgui_render_draw_list(struct ImDrawData * draw_data)
       struct ImDrawCmd * pcmd = ImDrawList_GetCmdPtr(cmd_list, (int32_t)j);
       if (pcmd->UserCallback)
       {
+        if (draw_count)
+          glDrawArraysInstancedBaseInstance(
+              /*GL_TRIANGLES*/ 0x0004, draw_first, draw_count, 1, 0);
+        draw_count = 0;
         pcmd->UserCallback(cmd_list, pcmd);
+        is_bound = false;
+        is_clipped = false;
       }
       else
       {
-        glScissor(
-            (int32_t)(pcmd->ClipRect.x), (int32_t)(h - pcmd->ClipRect.w),
-            (int32_t)(pcmd->ClipRect.z - pcmd->ClipRect.x),
-            (int32_t)(pcmd->ClipRect.w - pcmd->ClipRect.y));
-        glProgramUniform1iv(g_vert, 2, 1, &vtx_offset);
-        input[0] = *(uint32_t *)pcmd->TextureId;
-        glBindTextures(0, 4, input);
-        glDrawArraysInstancedBaseInstance(
-            /*GL_TRIANGLES*/ 0x0004, idx_offset, pcmd->ElemCount, 1, 0);
+        uint32_t texture = *(uint32_t *)pcmd->TextureId;
+        bool is_same_clip =
+            is_clipped &&
+            SDL_memcmp(&clip_rect, &pcmd->ClipRect, sizeof(clip_rect)) == 0;
+        if (!is_bound || !is_same_clip || texture != input[0])
+        {
+          if (draw_count)
+            glDrawArraysInstancedBaseInstance(
+                /*GL_TRIANGLES*/ 0x0004, draw_first, draw_count, 1, 0);
+          draw_first = idx_offset;
+          draw_count = 0;
+        }
+        if (!is_same_clip)
+        {
+          glScissor(
+              (int32_t)(pcmd->ClipRect.x), (int32_t)(h - pcmd->ClipRect.w),
+              (int32_t)(pcmd->ClipRect.z - pcmd->ClipRect.x),
+              (int32_t)(pcmd->ClipRect.w - pcmd->ClipRect.y));
+          clip_rect = pcmd->ClipRect;
+          is_clipped = true;
+        }
+        if (!is_bound || texture != input[0])
+        {
+          input[0] = texture;
+          glBindTextures(0, is_bound ? 1 : 4, input);
+          is_bound = true;
+        }
+        draw_count += pcmd->ElemCount;
       }
       idx_offset += pcmd->ElemCount;
     }
-    vtx_offset += ImDrawList_GetVertexBufferSize(cmd_list);
+  }
+  if (draw_count)
+    glDrawArraysInstancedBaseInstance(
+        /*GL_TRIANGLES*/ 0x0004, draw_first, draw_count, 1, 0);
+
+  // GL_SYNC_GPU_COMMANDS_COMPLETE
+  g_fences[g_frame] = glFenceSync(0x9117, 0);
+}
+
+static void imgui_render_draw_list(struct ImDrawData * draw_data)
+{
+  struct ImGuiIO * io = igGetIO();
+
+  struct ImVec2 fb_scale = io->DisplayFramebufferScale;
+  int32_t w = (int32_t)(io->DisplaySize.x * fb_scale.x);
+  int32_t h = (int32_t)(io->DisplaySize.y * fb_scale.y);
+
+  if (w <= 0 || h <= 0)
+    return;
+
+  ImDrawData_ScaleClipRects(draw_data, fb_scale);
+  glViewport(0, 0, w, h);
+
+  glDisable(/*GL_CULL_FACE*/ 0x0B44);
+  glDisable(/*GL_DEPTH_TEST*/ 0x0B71);
+  glDisable(/*GL_FRAMEBUFFER_SRGB*/ 0x8DB9);
+
+  if (w != g_layer_w || h != g_layer_h)
+    imgui_create_layer(w, h);
+
+  // The UI is rendered into an offscreen layer with premultiplied alpha only
+  // when its draw data changed, and the layer is composited every frame.
+  if (imgui_layer_is_dirty(draw_data))
+  {
+    int32_t fbo_id = 0;
+    float clear[4] = {};
+    glGetIntegerv(/*GL_DRAW_FRAMEBUFFER_BINDING*/ 0x8CA6, &fbo_id);
+    glBindFramebuffer(/*GL_DRAW_FRAMEBUFFER*/ 0x8CA9, g_layer_fbo_id);
+    glClearNamedFramebufferfv(g_layer_fbo_id, /*GL_COLOR*/ 0x1800, 0, clear);
+    // GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA
+    glBlendFuncSeparate(0x0302, 0x0303, 1, 0x0303);
+    glEnable(/*GL_SCISSOR_TEST*/ 0x0C11);
+    imgui_render_layer(draw_data, w, h);
+    glDisable(/*GL_SCISSOR_TEST*/ 0x0C11);
+    glBindFramebuffer(/*GL_DRAW_FRAMEBUFFER*/ 0x8CA9, (uint32_t)fbo_id);
   }
 
-  glDeleteBuffers(1, &idx_mem_id);
-  glDeleteBuffers(1, &vtx_mem_id);
-  glDeleteTextures(1, &idx_tex_id);
-  glDeleteTextures(1, &vtx_f32_tex_id);
-  glDeleteTextures(1, &vtx_u32_tex_id);
+  // GL_ONE, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA
+  glBlendFuncSeparate(1, 0x0303, 1, 0x0303);
+  glBindProgramPipeline(g_layer_ppo);
+  glBindTextures(0, 1, &g_layer_tex_id);
+  glDrawArraysInstancedBaseInstance(/*GL_TRIANGLES*/ 0x0004, 0, 3, 1, 0);
+  // GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA
+  glBlendFuncSeparate(0x0302, 0x0303, 0x0302, 0x0303);
 
   glEnable(/*GL_FRAMEBUFFER_SRGB*/ 0x8DB9);
-  glDisable(/*GL_SCISSOR_TEST*/ 0x0C11);
   glEnable(/*GL_DEPTH_TEST*/ 0x0B71);
   glEnable(/*GL_CULL_FACE*/ 0x0B44);
 }
@@ -342,6 +696,7 @@ bool imgui_process_event(SDL_Event * event)
       g_mouse_wheel = 1;
     if (event->wheel.y < 0)
       g_mouse_wheel = -1;
+    g_layer_is_dirty = true;
     return true;
   case (SDL_MOUSEBUTTONDOWN):
     if (event->button.button == SDL_BUTTON_LEFT)
@@ -350,9 +705,11 @@ bool imgui_process_event(SDL_Event * event)
       g_is_mouse_pressed[1] = true;
     if (event->button.button == SDL_BUTTON_MIDDLE)
       g_is_mouse_pressed[2] = true;
+    g_layer_is_dirty = true;
     return true;
   case (SDL_TEXTINPUT):
     ImGuiIO_AddInputCharactersUTF8(event->text.text);
+    g_layer_is_dirty = true;
     return true;
   case (SDL_KEYDOWN):
   {
@@ -362,6 +719,7 @@ bool imgui_process_event(SDL_Event * event)
     io->KeyCtrl = ((SDL_GetModState() & KMOD_CTRL) != 0);
     io->KeyAlt = ((SDL_GetModState() & KMOD_ALT) != 0);
     io->KeySuper = ((SDL_GetModState() & KMOD_GUI) != 0);
+    g_layer_is_dirty = true;
     return true;
   }
   case (SDL_KEYUP):
@@ -372,6 +730,7 @@ bool imgui_process_event(SDL_Event * event)
     io->KeyCtrl = ((SDL_GetModState() & KMOD_CTRL) != 0);
     io->KeyAlt = ((SDL_GetModState() & KMOD_ALT) != 0);
     io->KeySuper = ((SDL_GetModState() & KMOD_GUI) != 0);
+    g_layer_is_dirty = true;
     return true;
   }
   }
@@ -379,21 +738,146 @@ bool imgui_process_event(SDL_Event * event)
   return false;
 }
 
+// Sets the directory where baked font atlases are cached, NULL disables it.
+void imgui_font_cache(const char * dir)
+{
+  g_font_cache_dir[0] = 0;
+
+  if (dir == NULL)
+    return;
+
+  size_t length = SDL_strlen(dir);
+  const char * separator =
+      length > 0 && dir[length - 1] != '/' && dir[length - 1] != '\\' ? "/"
+                                                                      : "";
+
+  SDL_snprintf(
+      g_font_cache_dir, sizeof(g_font_cache_dir), "%s%s", dir, separator);
+}
+
+// Hashes the TTF data and every rasterization setting of the atlas fonts.
+static uint64_t imgui_font_hash(struct ImFontAtlas * atlas)
+{
+  uint64_t hash = 14695981039346656037ull;
+  for (int32_t i = 0, c = ImFontAtlas_GetConfigDataCount(atlas); i < c; ++i)
+  {
+    struct ImFontConfig * cfg = ImFontAtlas_GetConfigData(atlas, i);
+    hash = imgui_hash(hash, cfg->FontData, cfg->FontDataSize);
+    hash = imgui_hash(hash, &cfg->FontNo, sizeof(cfg->FontNo));
+    hash = imgui_hash(hash, &cfg->SizePixels, sizeof(cfg->SizePixels));
+    hash = imgui_hash(hash, &cfg->OversampleH, sizeof(cfg->OversampleH));
+    hash = imgui_hash(hash, &cfg->OversampleV, sizeof(cfg->OversampleV));
+    hash = imgui_hash(hash, &cfg->PixelSnapH, sizeof(cfg->PixelSnapH));
+    hash = imgui_hash(
+        hash, &cfg->GlyphExtraSpacing, sizeof(cfg->GlyphExtraSpacing));
+    hash = imgui_hash(hash, &cfg->MergeMode, sizeof(cfg->MergeMode));
+    hash = imgui_hash(
+        hash, &cfg->MergeGlyphCenterV, sizeof(cfg->MergeGlyphCenterV));
+    const ImWchar * ranges = cfg->GlyphRanges;
+    ptrdiff_t ranges_count = 0;
+    while (ranges && ranges[ranges_count])
+      ranges_count += 1;
+    hash = imgui_hash(hash, ranges, ranges_count * (ptrdiff_t)sizeof(ImWchar));
+    hash = imgui_hash(hash, &ranges_count, sizeof(ranges_count));
+  }
+  return hash;
+}
+
+static bool imgui_font_load(struct ImFontAtlas * atlas, const char * filepath)
+{
+  SDL_RWops * fd = SDL_RWFromFile(filepath, "rb");
+
+  if (fd == NULL)
+    return false;
+
+  SDL_RWseek(fd, 0, RW_SEEK_END);
+  int64_t bytes = SDL_RWtell(fd);
+  SDL_RWseek(fd, 0, RW_SEEK_SET);
+
+  void * baked = bytes > 0 ? SDL_malloc((size_t)bytes) : NULL;
+  bool is_loaded = baked && SDL_RWread(fd, baked, (size_t)bytes, 1) == 1 &&
+                   ImFontAtlas_LoadBaked(atlas, baked, (int32_t)bytes);
+
+  SDL_free(baked);
+  SDL_RWclose(fd);
+  return is_loaded;
+}
+
+static void imgui_font_save(struct ImFontAtlas * atlas, const char * filepath)
+{
+  int32_t bytes = ImFontAtlas_SaveBaked(atlas, NULL, 0);
+  void * baked = bytes > 0 ? SDL_malloc((size_t)bytes) : NULL;
+
+  if (baked == NULL)
+    return;
+
+  ImFontAtlas_SaveBaked(atlas, baked, bytes);
+
+  SDL_RWops * fd = SDL_RWFromFile(filepath, "wb");
+
+  if (fd)
+  {
+    SDL_RWwrite(fd, baked, (size_t)bytes, 1);
+    SDL_RWclose(fd);
+  }
+
+  SDL_free(baked);
+}
+
 void imgui_create_font_texture()
 {
-  // clang-format off
   struct ImGuiIO * io = igGetIO();
 
+  char filepath[4096 + 32] = {};
+  bool is_cached = false;
+
+  if (g_font_cache_dir[0] && ImFontAtlas_GetConfigDataCount(io->Fonts) > 0)
+  {
+    SDL_snprintf(
+        filepath, sizeof(filepath), "%sfont_%016llx.bin", g_font_cache_dir,
+        (unsigned long long)imgui_font_hash(io->Fonts));
+    is_cached = imgui_font_load(io->Fonts, filepath);
+  }
+
+  // The atlas only holds coverage, so it is stored as R8 and swizzled to
+  // white with the coverage in alpha, which keeps the fragment shader shared
+  // with user textures.
   uint8_t * pixels;
   int32_t width, height, bpp;
-  ImFontAtlas_GetTexDataAsRGBA32(io->Fonts, &pixels, &width, &height, &bpp);
+  ImFontAtlas_GetTexDataAsAlpha8(io->Fonts, &pixels, &width, &height, &bpp);
+
+  if (filepath[0] && !is_cached)
+    imgui_font_save(io->Fonts, filepath);
+
+  // GL_ONE, GL_ONE, GL_ONE, GL_RED
+  int32_t swizzle[4] = {1, 1, 1, 0x1903};
+
+  // clang-format off
   glCreateTextures(35866, 1, &g_font_texture);
-  glTextureStorage3D(g_font_texture, 1, /*GL_RGBA32F*/ 0x8814, width, height, 1);
-  glTextureSubImage3D(g_font_texture, 0, 0, 0, 0, width, height, 1, /*GL_RGBA*/ 0x1908, /*GL_UNSIGNED_BYTE*/ 0x1401, pixels);
+  glTextureStorage3D(g_font_texture, 1, /*GL_R8*/ 0x8229, width, height, 1);
+  glTextureSubImage3D(g_font_texture, 0, 0, 0, 0, width, height, 1, /*GL_RED*/ 0x1903, /*GL_UNSIGNED_BYTE*/ 0x1401, pixels);
+  glTextureParameteriv(g_font_texture, /*GL_TEXTURE_SWIZZLE_RGBA*/ 0x8E46, swizzle);
   ImFontAtlas_SetTexID(io->Fonts, &g_font_texture);
   // clang-format on
 }
 
+static uint32_t
+imgui_create_program(uint32_t shader_type, const char * shader_string)
+{
+  uint32_t shader_id = glCreateShader(shader_type);
+  glShaderSource(shader_id, 1, (const char **)&shader_string, NULL);
+  glCompileShader(shader_id);
+
+  uint32_t program_id = glCreateProgram();
+  glProgramParameteri(program_id, /*GL_PROGRAM_SEPARABLE*/ 0x8258, 1);
+  glAttachShader(program_id, shader_id);
+  glLinkProgram(program_id);
+  glDetachShader(program_id, shader_id);
+  glDeleteShader(shader_id);
+
+  return program_id;
+}
+
 void imgui_create_device_objects()
 {
   const char * vert_string =
@@ -412,23 +896,22 @@ void imgui_create_device_objects()
       "                                                                     \n"
       " layout(location = 0) uniform vec2 scale;                            \n"
       " layout(location = 1) uniform vec2 translate;                        \n"
-      " layout(location = 2) uniform int vtx_offset;                        \n"
       "                                                                     \n"
       " layout(binding = 1) uniform  samplerBuffer s_vtx_f32;               \n"
       " layout(binding = 2) uniform usamplerBuffer s_vtx_u32;               \n"
-      " layout(binding = 3) uniform isamplerBuffer s_idx;                   \n"
+      " layout(binding = 3) uniform usamplerBuffer s_idx;                   \n"
       "                                                                     \n"
       " layout(location = 0) out vec2 fs_uv;                                \n"
       " layout(location = 1) out vec4 fs_col;                               \n"
       "                                                                     \n"
       " void main()                                                         \n"
       " {                                                                   \n"
-      "   int i = texelFetch(s_idx, gl_VertexID).x;                         \n"
-      "   float posx = texelFetch(s_vtx_f32, (vtx_offset + i) * 5 + 0).x;   \n"
-      "   float posy = texelFetch(s_vtx_f32, (vtx_offset + i) * 5 + 1).x;   \n"
-      "   float uvx  = texelFetch(s_vtx_f32, (vtx_offset + i) * 5 + 2).x;   \n"
-      "   float uvy  = texelFetch(s_vtx_f32, (vtx_offset + i) * 5 + 3).x;   \n"
-      "   uint  col  = texelFetch(s_vtx_u32, (vtx_offset + i) * 5 + 4).x;   \n"
+      "   int i = int(texelFetch(s_idx, gl_VertexID).x);                    \n"
+      "   float posx = texelFetch(s_vtx_f32, i * 5 + 0).x;                  \n"
+      "   float posy = texelFetch(s_vtx_f32, i * 5 + 1).x;                  \n"
+      "   float uvx  = texelFetch(s_vtx_f32, i * 5 + 2).x;                  \n"
+      "   float uvy  = texelFetch(s_vtx_f32, i * 5 + 3).x;                  \n"
+      "   uint  col  = texelFetch(s_vtx_u32, i * 5 + 4).x;                  \n"
       "   fs_uv = vec2(uvx, uvy);                                           \n"
       "   fs_col = unpackUnorm4x8(col);                                     \n"
       "   gl_Position = vec4(fma(vec2(posx, posy), scale, translate), 0, 1);\n"
@@ -460,37 +943,48 @@ void imgui_create_device_objects()
       "   color = fs_col * texture(s_texture, vec3(fs_uv.st, 0));\n"
       " }                                                        \n";
 
-  uint32_t vert_shader_id = glCreateShader(/*GL_VERTEX_SHADER*/ 0x8B31);
-  uint32_t frag_shader_id = glCreateShader(/*GL_FRAGMENT_SHADER*/ 0x8B30);
-
-  glShaderSource(vert_shader_id, 1, (const char **)&vert_string, NULL);
-  glShaderSource(frag_shader_id, 1, (const char **)&frag_string, NULL);
-
-  glCompileShader(vert_shader_id);
-  glCompileShader(frag_shader_id);
-
-  g_vert = glCreateProgram();
-  g_frag = glCreateProgram();
-
-  glProgramParameteri(g_vert, /*GL_PROGRAM_SEPARABLE*/ 0x8258, 1);
-  glProgramParameteri(g_frag, /*GL_PROGRAM_SEPARABLE*/ 0x8258, 1);
-
-  glAttachShader(g_vert, vert_shader_id);
-  glAttachShader(g_frag, frag_shader_id);
-
-  glLinkProgram(g_vert);
-  glLinkProgram(g_frag);
+  const char * layer_vert_string =
+      "#version 330                                                \n"
+      "#extension GL_ARB_separate_shader_objects   : enable        \n"
+      "                                                            \n"
+      " out gl_PerVertex { vec4 gl_Position; };                    \n"
+      "                                                            \n"
+      " void main()                                                \n"
+      " {                                                          \n"
+      "   vec2 pos = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);\n"
+      "   gl_Position = vec4(pos * 2 - 1, 0, 1);                   \n"
+      " }                                                          \n";
 
-  glDetachShader(g_vert, vert_shader_id);
-  glDetachShader(g_frag, frag_shader_id);
+  const char * layer_frag_string =
+      "#version 330                                                       \n"
+      "#extension GL_ARB_separate_shader_objects   : enable               \n"
+      "#extension GL_ARB_shading_language_420pack  : enable               \n"
+      "                                                                   \n"
+      " layout(binding = 0) uniform sampler2DArray s_layer;               \n"
+      "                                                                   \n"
+      " out vec4 color;                                                   \n"
+      "                                                                   \n"
+      " void main()                                                       \n"
+      " {                                                                 \n"
+      "   color = texelFetch(s_layer, ivec3(ivec2(gl_FragCoord.xy), 0), 0);\n"
+      " }                                                                 \n";
 
-  glDeleteShader(vert_shader_id);
-  glDeleteShader(frag_shader_id);
+  g_vert = imgui_create_program(/*GL_VERTEX_SHADER*/ 0x8B31, vert_string);
+  g_frag = imgui_create_program(/*GL_FRAGMENT_SHADER*/ 0x8B30, frag_string);
+  g_layer_vert =
+      imgui_create_program(/*GL_VERTEX_SHADER*/ 0x8B31, layer_vert_string);
+  g_layer_frag =
+      imgui_create_program(/*GL_FRAGMENT_SHADER*/ 0x8B30, layer_frag_string);
 
   glCreateProgramPipelines(1, &g_ppo);
+  glCreateProgramPipelines(1, &g_layer_ppo);
 
+  // clang-format off
   glUseProgramStages(g_ppo, /*GL_VERTEX_SHADER_BIT*/ 0x00000001, g_vert);
   glUseProgramStages(g_ppo, /*GL_FRAGMENT_SHADER_BIT*/ 0x00000002, g_frag);
+  glUseProgramStages(g_layer_ppo, /*GL_VERTEX_SHADER_BIT*/ 0x00000001, g_layer_vert);
+  glUseProgramStages(g_layer_ppo, /*GL_FRAGMENT_SHADER_BIT*/ 0x00000002, g_layer_frag);
+  // clang-format on
 
   imgui_create_font_texture();
 }
@@ -537,6 +1031,11 @@ void imgui_new_frame(SDL_Window * sdl_window)
 
   SDL_ShowCursor(io->MouseDrawCursor ? 0 : 1);
 
+  g_mem.last_frame = g_mem.frame;
+  g_mem.frame.allocs = 0;
+  g_mem.frame.frees = 0;
+  g_mem.frame.peak_bytes = g_mem.frame.bytes;
+
   igNewFrame();
 }
 
@@ -547,7 +1046,13 @@ static void imgui_invalidate_device_objects()
   glDeleteProgram(g_vert);
   glDeleteProgram(g_frag);
   glDeleteProgramPipelines(1, &g_ppo);
+  glDeleteProgram(g_layer_vert);
+  glDeleteProgram(g_layer_frag);
+  glDeleteProgramPipelines(1, &g_layer_ppo);
   g_vert = 0, g_frag = 0, g_ppo = 0;
+  g_layer_vert = 0, g_layer_frag = 0, g_layer_ppo = 0;
+  imgui_delete_streaming_buffers();
+  imgui_delete_layer();
   if (g_font_texture)
   {
     glDeleteTextures(1, &g_font_texture);
@@ -560,12 +1065,20 @@ static void imgui_deinit()
 {
   imgui_invalidate_device_objects();
   igShutdown();
+
+  // Chunks are only released once ImGui returned every block
+  if (g_mem.live == 0)
+    imgui_mem_release();
 }
 
 static void imgui_init()
 {
   struct ImGuiIO * io = igGetIO();
 
+  // Must be installed before ImGui allocates anything
+  io->MemAllocFn = imgui_mem_alloc;
+  io->MemFreeFn = imgui_mem_free;
+
   io->KeyMap[ImGuiKey_Tab] = SDLK_TAB;
   io->KeyMap[ImGuiKey_LeftArrow] = SDL_SCANCODE_LEFT;
   io->KeyMap[ImGuiKey_RightArrow] = SDL_SCANCODE_RIGHT;
@@ -644,3 +1157,103 @@ static void imgui_easy_theming(
   style->Colors[ImGuiCol_ModalWindowDarkening] = (struct ImVec4){color_for_area.x, color_for_area.y, color_for_area.z, 0.73f};
   // clang-format on
 }
+
+// Available when gpulib.h is included before this header.
+#ifdef GPU_PROF_SCOPES
+
+#define IMGUI_PROF_SERIES 64
+#define IMGUI_PROF_HISTORY 120
+
+static struct
+{
+  uint64_t result_id;
+  int32_t offset;
+  int32_t series_count;
+  struct
+  {
+    const char * name;
+    int32_t depth;
+    int32_t calls;
+    float ms[IMGUI_PROF_HISTORY];
+  } series[IMGUI_PROF_SERIES];
+} g_prof = {};
+
+static void imgui_gpu_prof_update()
+{
+  if (g_prof.result_id == gpu_prof.result_id)
+    return;
+
+  g_prof.result_id = gpu_prof.result_id;
+  g_prof.offset = (g_prof.offset + 1) % IMGUI_PROF_HISTORY;
+
+  for (int32_t i = 0; i < g_prof.series_count; ++i)
+  {
+    g_prof.series[i].calls = 0;
+    g_prof.series[i].ms[g_prof.offset] = 0;
+  }
+
+  const struct gpu_prof_scope_t * scopes = NULL;
+  int32_t scopes_count = gpu_prof_results(&scopes);
+
+  for (int32_t i = 0; i < scopes_count; ++i)
+  {
+    int32_t s = 0;
+    for (; s < g_prof.series_count; ++s)
+    {
+      if (g_prof.series[s].depth == scopes[i].depth &&
+          (g_prof.series[s].name == scopes[i].name ||
+           SDL_strcmp(g_prof.series[s].name, scopes[i].name) == 0))
+        break;
+    }
+
+    if (s == g_prof.series_count)
+    {
+      if (s == IMGUI_PROF_SERIES)
+        continue;
+
+      g_prof.series_count += 1;
+      g_prof.series[s].name = scopes[i].name;
+      g_prof.series[s].depth = scopes[i].depth;
+      g_prof.series[s].calls = 0;
+      SDL_memset(g_prof.series[s].ms, 0, sizeof(g_prof.series[s].ms));
+    }
+
+    g_prof.series[s].calls += 1;
+    g_prof.series[s].ms[g_prof.offset] += scopes[i].ms;
+  }
+}
+
+static void imgui_gpu_prof_panel(bool * p_open)
+{
+  imgui_gpu_prof_update();
+
+  if (!igBegin("GPU profiler", p_open, 0))
+  {
+    igEnd();
+    return;
+  }
+
+  bool is_enabled = gpu_prof.is_enabled;
+  if (igCheckbox("Enabled", &is_enabled))
+    gpu_prof_enable(is_enabled);
+
+  for (int32_t i = 0; i < g_prof.series_count; ++i)
+  {
+    float indent = 16.f * (float)(g_prof.series[i].depth + 1);
+    igPushIdInt(i);
+    igIndent(indent);
+    igText(
+        "%s x%d: %.3f ms", g_prof.series[i].name, g_prof.series[i].calls,
+        g_prof.series[i].ms[g_prof.offset]);
+    igPlotLines(
+        "", g_prof.series[i].ms, IMGUI_PROF_HISTORY,
+        (g_prof.offset + 1) % IMGUI_PROF_HISTORY, NULL, 0, 3.402823466e+38f,
+        (struct ImVec2){0, 40}, sizeof(float));
+    igUnindent(indent);
+    igPopId();
+  }
+
+  igEnd();
+}
+
+#endif
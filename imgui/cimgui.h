@@ -423,6 +423,10 @@ CIMGUI_API CONST ImWchar*   ImFontAtlas_GetGlyphRangesKorean(struct ImFontAtlas*
 CIMGUI_API CONST ImWchar*   ImFontAtlas_GetGlyphRangesJapanese(struct ImFontAtlas* atlas);
 CIMGUI_API CONST ImWchar*   ImFontAtlas_GetGlyphRangesChinese(struct ImFontAtlas* atlas);
 CIMGUI_API CONST ImWchar*   ImFontAtlas_GetGlyphRangesCyrillic(struct ImFontAtlas* atlas);
+CIMGUI_API int              ImFontAtlas_GetConfigDataCount(struct ImFontAtlas* atlas);
+CIMGUI_API struct ImFontConfig* ImFontAtlas_GetConfigData(struct ImFontAtlas* atlas, int n);
+CIMGUI_API int              ImFontAtlas_SaveBaked(struct ImFontAtlas* atlas, void* data, int size);
+CIMGUI_API bool             ImFontAtlas_LoadBaked(struct ImFontAtlas* atlas, CONST void* data, int size);
 
 CIMGUI_API void             ImGuiIO_AddInputCharacter(unsigned short c);
 CIMGUI_API void             ImGuiIO_AddInputCharactersUTF8(CONST char* utf8_chars);
@@ -1,5 +1,6 @@
 
 #include "../imgui/imgui.h"
+#include "../imgui/stb_rect_pack.h"
 #include "cimgui.h"
 
 CIMGUI_API void ImFontConfig_DefaultConstructor(ImFontConfig* config)
@@ -85,4 +86,152 @@ CIMGUI_API CONST ImWchar*   ImFontAtlas_GetGlyphRangesChinese(struct ImFontAtlas
 CIMGUI_API CONST ImWchar*   ImFontAtlas_GetGlyphRangesCyrillic(struct ImFontAtlas* atlas)
 {
 	return atlas->GetGlyphRangesCyrillic();
-}
\ No newline at end of file
+}
+CIMGUI_API int ImFontAtlas_GetConfigDataCount(struct ImFontAtlas* atlas)
+{
+	return atlas->ConfigData.Size;
+}
+
+CIMGUI_API struct ImFontConfig* ImFontAtlas_GetConfigData(struct ImFontAtlas* atlas, int n)
+{
+	return &atlas->ConfigData[n];
+}
+
+// Baked atlas: alpha pixels and glyph tables of every font, enough to restore the
+// atlas without rasterizing its TTF data again. Only meaningful for the same fonts
+// added in the same order, with the same build of this library.
+struct ImFontAtlasBakedHeader
+{
+	unsigned int Magic;
+	unsigned int GlyphSize;
+	int TexWidth, TexHeight;
+	ImVec2 TexUvWhitePixel;
+	int FontCount;
+};
+
+struct ImFontBakedHeader
+{
+	float FontSize;
+	float Ascent, Descent;
+	int ConfigDataCount;
+	int GlyphCount;
+};
+
+CIMGUI_API int ImFontAtlas_SaveBaked(struct ImFontAtlas* atlas, void* data, int size)
+{
+	if (atlas->TexPixelsAlpha8 == NULL)
+		return 0;
+
+	int required = (int)sizeof(ImFontAtlasBakedHeader) + atlas->TexWidth * atlas->TexHeight;
+	for (int i = 0; i < atlas->Fonts.Size; i++)
+		required += (int)sizeof(ImFontBakedHeader) + atlas->Fonts[i]->Glyphs.Size * (int)sizeof(ImFont::Glyph);
+
+	if (data == NULL || size < required)
+		return required;
+
+	char* p = (char*)data;
+	ImFontAtlasBakedHeader header;
+	header.Magic = 0x31424641; // "AFB1"
+	header.GlyphSize = (unsigned int)sizeof(ImFont::Glyph);
+	header.TexWidth = atlas->TexWidth;
+	header.TexHeight = atlas->TexHeight;
+	header.TexUvWhitePixel = atlas->TexUvWhitePixel;
+	header.FontCount = atlas->Fonts.Size;
+	memcpy(p, &header, sizeof(header));
+	p += sizeof(header);
+
+	for (int i = 0; i < atlas->Fonts.Size; i++)
+	{
+		ImFont* font = atlas->Fonts[i];
+		ImFontBakedHeader font_header;
+		font_header.FontSize = font->FontSize;
+		font_header.Ascent = font->Ascent;
+		font_header.Descent = font->Descent;
+		font_header.ConfigDataCount = font->ConfigDataCount;
+		font_header.GlyphCount = font->Glyphs.Size;
+		memcpy(p, &font_header, sizeof(font_header));
+		p += sizeof(font_header);
+		memcpy(p, font->Glyphs.Data, font->Glyphs.Size * sizeof(ImFont::Glyph));
+		p += font->Glyphs.Size * sizeof(ImFont::Glyph);
+	}
+
+	memcpy(p, atlas->TexPixelsAlpha8, (size_t)(atlas->TexWidth * atlas->TexHeight));
+	return required;
+}
+
+CIMGUI_API bool ImFontAtlas_LoadBaked(struct ImFontAtlas* atlas, CONST void* data, int size)
+{
+	const char* p = (const char*)data;
+	const char* end = p + size;
+
+	ImFontAtlasBakedHeader header;
+	if (size < (int)sizeof(header))
+		return false;
+	memcpy(&header, p, sizeof(header));
+	p += sizeof(header);
+
+	if (header.Magic != 0x31424641 || header.GlyphSize != sizeof(ImFont::Glyph) ||
+		header.FontCount != atlas->Fonts.Size || header.TexWidth <= 0 || header.TexHeight <= 0)
+		return false;
+
+	// Validate the whole blob before touching the atlas
+	const char* q = p;
+	for (int i = 0; i < header.FontCount; i++)
+	{
+		ImFontBakedHeader font_header;
+		if (end - q < (ptrdiff_t)sizeof(font_header))
+			return false;
+		memcpy(&font_header, q, sizeof(font_header));
+		q += sizeof(font_header);
+		if (font_header.GlyphCount < 0 || end - q < (ptrdiff_t)(font_header.GlyphCount * sizeof(ImFont::Glyph)))
+			return false;
+		q += font_header.GlyphCount * sizeof(ImFont::Glyph);
+	}
+	if (end - q != (ptrdiff_t)header.TexWidth * header.TexHeight)
+		return false;
+
+	atlas->ClearTexData();
+	atlas->TexID = NULL;
+	atlas->TexWidth = header.TexWidth;
+	atlas->TexHeight = header.TexHeight;
+	atlas->TexPixelsAlpha8 = (unsigned char*)ImGui::MemAlloc((size_t)(header.TexWidth * header.TexHeight));
+	memcpy(atlas->TexPixelsAlpha8, q, (size_t)(header.TexWidth * header.TexHeight));
+
+	for (int i = 0; i < atlas->ConfigData.Size; i++)
+	{
+		ImFontConfig& cfg = atlas->ConfigData[i];
+		if (!cfg.GlyphRanges)
+			cfg.GlyphRanges = atlas->GetGlyphRangesDefault();
+		if (!cfg.MergeMode)
+		{
+			cfg.DstFont->ContainerAtlas = atlas;
+			cfg.DstFont->ConfigData = &cfg;
+		}
+	}
+
+	for (int i = 0; i < header.FontCount; i++)
+	{
+		ImFont* font = atlas->Fonts[i];
+		ImFontBakedHeader font_header;
+		memcpy(&font_header, p, sizeof(font_header));
+		p += sizeof(font_header);
+		font->FontSize = font_header.FontSize;
+		font->Ascent = font_header.Ascent;
+		font->Descent = font_header.Descent;
+		font->ConfigDataCount = (short)font_header.ConfigDataCount;
+		font->Glyphs.resize(font_header.GlyphCount);
+		memcpy(font->Glyphs.Data, p, font_header.GlyphCount * sizeof(ImFont::Glyph));
+		p += font_header.GlyphCount * sizeof(ImFont::Glyph);
+		font->FallbackGlyph = NULL;
+		font->BuildLookupTable();
+	}
+
+	// The custom data block sits where the white pixel is, re-rendering it restores the mouse cursors
+	ImVector<stbrp_rect> rects;
+	rects.resize(1);
+	memset(&rects[0], 0, sizeof(stbrp_rect));
+	rects[0].x = (stbrp_coord)(header.TexUvWhitePixel.x * header.TexWidth);
+	rects[0].y = (stbrp_coord)(header.TexUvWhitePixel.y * header.TexHeight);
+	atlas->RenderCustomTexData(1, &rects);
+	return true;
+}
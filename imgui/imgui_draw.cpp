@@ -48,6 +48,20 @@
 #pragma GCC diagnostic ignored "-Wconversion"               // warning: conversion to 'xxxx' from 'xxxx' may alter its value
 #endif
 
+// Anti-aliased path tessellation uses SSE2 when available, define IMGUI_DISABLE_SIMD_TESSELLATION to force the scalar code.
+// The NEON version is opt-in with IMGUI_ENABLE_NEON_TESSELLATION until it has been verified on AArch64 hardware.
+// The SIMD code performs the same IEEE operations in the same order as the scalar code, and FP contraction is turned off for
+// both, so their output is bit-exact. Define IMGUI_DEBUG_TESSELLATION to assert it at runtime.
+#if !defined(IMGUI_DISABLE_SIMD_TESSELLATION)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IMGUI_SIMD_TESSELLATION_SSE2
+#include <emmintrin.h>
+#elif defined(IMGUI_ENABLE_NEON_TESSELLATION) && (defined(__aarch64__) || defined(_M_ARM64))
+#define IMGUI_SIMD_TESSELLATION_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
 //-------------------------------------------------------------------------
 // STB libraries implementation
 //-------------------------------------------------------------------------
@@ -412,6 +426,173 @@ void ImDrawList::PrimQuadUV(const ImVec2& a, const ImVec2& b, const ImVec2& c, c
     _IdxWritePtr += 6;
 }
 
+// GCC and clang contract a*b+c into FMA instructions by default on targets that have them (GCC even across statements),
+// which rounds differently than the separate multiplies and adds of the SIMD kernels. Turn it off for the kernels and their
+// scalar counterparts, the latter compute lengths inline since contraction follows the settings where the code is written.
+// MSVC only contracts with /fp:contract or /fp:fast.
+#if defined(__clang__)
+#define IM_FP_CONTRACT_OFF _Pragma("clang fp contract(off)")
+#else
+#define IM_FP_CONTRACT_OFF
+#if defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC optimize("fp-contract=off")
+#endif
+#endif
+
+// Normals of the segments [i, i+1] for i in [0, count), the last segment wraps to the first point when count == points_count.
+static void ImPolylineNormalsScalar(const ImVec2* points, const int points_count, int i, const int count, ImVec2* normals)
+{
+    IM_FP_CONTRACT_OFF
+    for (; i < count; i++)
+    {
+        const int i2 = (i+1) == points_count ? 0 : i+1;
+        ImVec2 diff = points[i2] - points[i];
+        float d = diff.x*diff.x + diff.y*diff.y;
+        if (d > 0.0f)
+            diff *= 1.0f / sqrtf(d);
+        normals[i].x = diff.y;
+        normals[i].y = -diff.x;
+    }
+}
+
+// Averaged normals of the points i+1 (wrapping), scaled to keep the fringe width on sharp corners, for i in [0, count).
+static void ImPolylineMitersScalar(const ImVec2* normals, const int points_count, int i, const int count, ImVec2* miters)
+{
+    IM_FP_CONTRACT_OFF
+    for (; i < count; i++)
+    {
+        const int i2 = (i+1) == points_count ? 0 : i+1;
+        ImVec2 dm = (normals[i] + normals[i2]) * 0.5f;
+        float dmr2 = dm.x*dm.x + dm.y*dm.y;
+        if (dmr2 > 0.000001f)
+        {
+            float scale = 1.0f / dmr2;
+            if (scale > 100.0f) scale = 100.0f;
+            dm *= scale;
+        }
+        miters[i] = dm;
+    }
+}
+
+// The SIMD kernels work on interleaved (x, y) pairs, two points per register. x*x+y*y is computed as x*x+y*y in x lanes
+// and y*y+x*x in y lanes, which is the same value. They return the first index left for the scalar code, the one whose
+// segment wraps around is always left to it.
+#if defined(IMGUI_SIMD_TESSELLATION_SSE2)
+static int ImPolylineNormalsSIMD(const ImVec2* points, const int points_count, const int count, ImVec2* normals)
+{
+    IM_FP_CONTRACT_OFF
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 sign_y = _mm_castsi128_ps(_mm_set_epi32((int)0x80000000, 0, (int)0x80000000, 0));
+    int i = 0;
+    for (; i + 2 < points_count && i + 2 <= count; i += 2)
+    {
+        __m128 diff = _mm_sub_ps(_mm_loadu_ps(&points[i+1].x), _mm_loadu_ps(&points[i].x));
+        __m128 sq = _mm_mul_ps(diff, diff);
+        __m128 d = _mm_add_ps(sq, _mm_shuffle_ps(sq, sq, _MM_SHUFFLE(2,3,0,1)));
+        __m128 mask = _mm_cmpgt_ps(d, zero);
+        __m128 inv = _mm_div_ps(one, _mm_sqrt_ps(d));
+        inv = _mm_or_ps(_mm_and_ps(mask, inv), _mm_andnot_ps(mask, one));
+        diff = _mm_mul_ps(diff, inv);
+        _mm_storeu_ps(&normals[i].x, _mm_xor_ps(_mm_shuffle_ps(diff, diff, _MM_SHUFFLE(2,3,0,1)), sign_y));
+    }
+    return i;
+}
+
+static int ImPolylineMitersSIMD(const ImVec2* normals, const int points_count, const int count, ImVec2* miters)
+{
+    IM_FP_CONTRACT_OFF
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 epsilon = _mm_set1_ps(0.000001f);
+    const __m128 scale_max = _mm_set1_ps(100.0f);
+    int i = 0;
+    for (; i + 2 < points_count && i + 2 <= count; i += 2)
+    {
+        __m128 dm = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(&normals[i].x), _mm_loadu_ps(&normals[i+1].x)), half);
+        __m128 sq = _mm_mul_ps(dm, dm);
+        __m128 dmr2 = _mm_add_ps(sq, _mm_shuffle_ps(sq, sq, _MM_SHUFFLE(2,3,0,1)));
+        __m128 mask = _mm_cmpgt_ps(dmr2, epsilon);
+        __m128 scale = _mm_min_ps(_mm_div_ps(one, dmr2), scale_max);
+        dm = _mm_or_ps(_mm_and_ps(mask, _mm_mul_ps(dm, scale)), _mm_andnot_ps(mask, dm));
+        _mm_storeu_ps(&miters[i].x, dm);
+    }
+    return i;
+}
+#elif defined(IMGUI_SIMD_TESSELLATION_NEON)
+static int ImPolylineNormalsSIMD(const ImVec2* points, const int points_count, const int count, ImVec2* normals)
+{
+    IM_FP_CONTRACT_OFF
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    const uint32_t sign_y_bits[4] = { 0, 0x80000000, 0, 0x80000000 };
+    const uint32x4_t sign_y = vld1q_u32(sign_y_bits);
+    int i = 0;
+    for (; i + 2 < points_count && i + 2 <= count; i += 2)
+    {
+        float32x4_t diff = vsubq_f32(vld1q_f32(&points[i+1].x), vld1q_f32(&points[i].x));
+        float32x4_t sq = vmulq_f32(diff, diff);
+        float32x4_t d = vaddq_f32(sq, vrev64q_f32(sq));
+        uint32x4_t mask = vcgtq_f32(d, zero);
+        float32x4_t inv = vbslq_f32(mask, vdivq_f32(one, vsqrtq_f32(d)), one);
+        diff = vmulq_f32(diff, inv);
+        vst1q_f32(&normals[i].x, vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(vrev64q_f32(diff)), sign_y)));
+    }
+    return i;
+}
+
+static int ImPolylineMitersSIMD(const ImVec2* normals, const int points_count, const int count, ImVec2* miters)
+{
+    IM_FP_CONTRACT_OFF
+    const float32x4_t half = vdupq_n_f32(0.5f);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    const float32x4_t epsilon = vdupq_n_f32(0.000001f);
+    const float32x4_t scale_max = vdupq_n_f32(100.0f);
+    int i = 0;
+    for (; i + 2 < points_count && i + 2 <= count; i += 2)
+    {
+        float32x4_t dm = vmulq_f32(vaddq_f32(vld1q_f32(&normals[i].x), vld1q_f32(&normals[i+1].x)), half);
+        float32x4_t sq = vmulq_f32(dm, dm);
+        float32x4_t dmr2 = vaddq_f32(sq, vrev64q_f32(sq));
+        uint32x4_t mask = vcgtq_f32(dmr2, epsilon);
+        float32x4_t scale = vminq_f32(vdivq_f32(one, dmr2), scale_max);
+        vst1q_f32(&miters[i].x, vbslq_f32(mask, vmulq_f32(dm, scale), dm));
+    }
+    return i;
+}
+#else
+static int ImPolylineNormalsSIMD(const ImVec2*, const int, const int, ImVec2*) { return 0; }
+static int ImPolylineMitersSIMD(const ImVec2*, const int, const int, ImVec2*) { return 0; }
+#endif
+
+static void ImPolylineNormals(const ImVec2* points, const int points_count, const int count, ImVec2* normals)
+{
+    int i = ImPolylineNormalsSIMD(points, points_count, count, normals);
+    ImPolylineNormalsScalar(points, points_count, i, count, normals);
+#ifdef IMGUI_DEBUG_TESSELLATION
+    ImVec2* reference = (ImVec2*)alloca(count * sizeof(ImVec2));
+    ImPolylineNormalsScalar(points, points_count, 0, count, reference);
+    IM_ASSERT(memcmp(reference, normals, count * sizeof(ImVec2)) == 0);
+#endif
+}
+
+static void ImPolylineMiters(const ImVec2* normals, const int points_count, const int count, ImVec2* miters)
+{
+    int i = ImPolylineMitersSIMD(normals, points_count, count, miters);
+    ImPolylineMitersScalar(normals, points_count, i, count, miters);
+#ifdef IMGUI_DEBUG_TESSELLATION
+    ImVec2* reference = (ImVec2*)alloca(count * sizeof(ImVec2));
+    ImPolylineMitersScalar(normals, points_count, 0, count, reference);
+    IM_ASSERT(memcmp(reference, miters, count * sizeof(ImVec2)) == 0);
+#endif
+}
+
+#if !defined(__clang__) && defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+#undef IM_FP_CONTRACT_OFF
+
 // TODO: Thickness anti-aliased lines cap are missing their AA fringe.
 void ImDrawList::AddPolyline(const ImVec2* points, const int points_count, ImU32 col, bool closed, float thickness, bool anti_aliased)
 {
@@ -438,19 +619,14 @@ void ImDrawList::AddPolyline(const ImVec2* points, const int points_count, ImU32
         PrimReserve(idx_count, vtx_count);
 
         // Temporary buffer
-        ImVec2* temp_normals = (ImVec2*)alloca(points_count * (thick_line ? 5 : 3) * sizeof(ImVec2));
-        ImVec2* temp_points = temp_normals + points_count;
+        ImVec2* temp_normals = (ImVec2*)alloca(points_count * (thick_line ? 6 : 4) * sizeof(ImVec2));
+        ImVec2* temp_miters = temp_normals + points_count;
+        ImVec2* temp_points = temp_miters + points_count;
 
-        for (int i1 = 0; i1 < count; i1++)
-        {
-            const int i2 = (i1+1) == points_count ? 0 : i1+1;
-            ImVec2 diff = points[i2] - points[i1];
-            diff *= ImInvLength(diff, 1.0f);
-            temp_normals[i1].x = diff.y;
-            temp_normals[i1].y = -diff.x;
-        }
+        ImPolylineNormals(points, points_count, count, temp_normals);
         if (!closed)
             temp_normals[points_count-1] = temp_normals[points_count-2];
+        ImPolylineMiters(temp_normals, points_count, count, temp_miters);
 
         if (!thick_line)
         {
@@ -470,14 +646,7 @@ void ImDrawList::AddPolyline(const ImVec2* points, const int points_count, ImU32
                 unsigned int idx2 = (i1+1) == points_count ? _VtxCurrentIdx : idx1+3;
 
                 // Average normals
-                ImVec2 dm = (temp_normals[i1] + temp_normals[i2]) * 0.5f;
-                float dmr2 = dm.x*dm.x + dm.y*dm.y;
-                if (dmr2 > 0.000001f)
-                {
-                    float scale = 1.0f / dmr2;
-                    if (scale > 100.0f) scale = 100.0f;
-                    dm *= scale;
-                }
+                ImVec2 dm = temp_miters[i1];
                 dm *= AA_SIZE;
                 temp_points[i2*2+0] = points[i2] + dm;
                 temp_points[i2*2+1] = points[i2] - dm;
@@ -524,14 +693,7 @@ void ImDrawList::AddPolyline(const ImVec2* points, const int points_count, ImU32
                 unsigned int idx2 = (i1+1) == points_count ? _VtxCurrentIdx : idx1+4;
 
                 // Average normals
-                ImVec2 dm = (temp_normals[i1] + temp_normals[i2]) * 0.5f;
-                float dmr2 = dm.x*dm.x + dm.y*dm.y;
-                if (dmr2 > 0.000001f)
-                {
-                    float scale = 1.0f / dmr2;
-                    if (scale > 100.0f) scale = 100.0f;
-                    dm *= scale;
-                }
+                ImVec2 dm = temp_miters[i1];
                 ImVec2 dm_out = dm * (half_inner_thickness + AA_SIZE);
                 ImVec2 dm_in = dm * half_inner_thickness;
                 temp_points[i2*4+0] = points[i2] + dm_out;
@@ -619,30 +781,15 @@ void ImDrawList::AddConvexPolyFilled(const ImVec2* points, const int points_coun
         }
 
         // Compute normals
-        ImVec2* temp_normals = (ImVec2*)alloca(points_count * sizeof(ImVec2));
-        for (int i0 = points_count-1, i1 = 0; i1 < points_count; i0 = i1++)
-        {
-            const ImVec2& p0 = points[i0];
-            const ImVec2& p1 = points[i1];
-            ImVec2 diff = p1 - p0;
-            diff *= ImInvLength(diff, 1.0f);
-            temp_normals[i0].x = diff.y;
-            temp_normals[i0].y = -diff.x;
-        }
+        ImVec2* temp_normals = (ImVec2*)alloca(points_count * 2 * sizeof(ImVec2));
+        ImVec2* temp_miters = temp_normals + points_count;
+        ImPolylineNormals(points, points_count, points_count, temp_normals);
+        ImPolylineMiters(temp_normals, points_count, points_count, temp_miters);
 
         for (int i0 = points_count-1, i1 = 0; i1 < points_count; i0 = i1++)
         {
             // Average normals
-            const ImVec2& n0 = temp_normals[i0];
-            const ImVec2& n1 = temp_normals[i1];
-            ImVec2 dm = (n0 + n1) * 0.5f;
-            float dmr2 = dm.x*dm.x + dm.y*dm.y;
-            if (dmr2 > 0.000001f)
-            {
-                float scale = 1.0f / dmr2;
-                if (scale > 100.0f) scale = 100.0f;
-                dm *= scale;
-            }
+            ImVec2 dm = temp_miters[i0];
             dm *= AA_SIZE * 0.5f;
 
             // Add vertices